@@ -0,0 +1,170 @@
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "book_index.h"
+#include "harness.h"
+#include "intersect.h"
+
+// Synthetic catalog: titles of 2-6 words drawn Zipf-like from a 20K-word
+// vocabulary, authors from 2K first and 5K last names.
+namespace {
+
+const int kVocabulary = 20000;
+
+std::string word(int i) {
+    static const char* syllables[] = {"ka", "lo", "mi", "ne", "ru", "sa", "ti", "vo", "ze", "da", "pe", "gu"};
+    std::string w;
+    do {
+        w += syllables[i % 12];
+        i /= 12;
+    } while (i > 0);
+    return w;
+}
+
+struct Corpus {
+    std::mt19937 rng{99};
+    std::vector<double> cdf;
+
+    Corpus() {
+        double sum = 0;
+        for (int i = 1; i <= kVocabulary; i++) {
+            sum += 1.0 / i;
+            cdf.push_back(sum);
+        }
+        for (double& c : cdf) c /= sum;
+    }
+
+    int zipfWord() {
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        return (int)(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+    }
+
+    std::string title() {
+        int words = 2 + (int)(rng() % 5);
+        std::string t;
+        for (int w = 0; w < words; w++) {
+            if (w) t += ' ';
+            t += word(zipfWord());
+        }
+        return t;
+    }
+
+    std::string author() {
+        return word(100 + rng() % 2000) + " " + word(3000 + rng() % 5000);
+    }
+};
+
+struct Catalog {
+    BookIndex index;
+    std::vector<std::string> titles, authors; // for the substring-scan baseline
+    std::vector<std::string> queries;
+};
+
+// built once per size and kept for the rest of the run
+Catalog& catalog(int books) {
+    static std::map<int, std::unique_ptr<Catalog>> built;
+    auto& slot = built[books];
+    if (!slot) {
+        slot = std::make_unique<Catalog>();
+        Corpus corpus;
+        for (int i = 0; i < books; i++) {
+            Book b(corpus.title(), corpus.author());
+            slot->index.add(b);
+            if (books <= 100000) {
+                slot->titles.push_back(b.getTitle());
+                slot->authors.push_back(b.getAuthor());
+            }
+        }
+        // two-term queries mixing common and mid-frequency words
+        for (int q = 0; q < 256; q++) {
+            slot->queries.push_back(word(corpus.zipfWord()) + " " + word(corpus.zipfWord() % 500));
+        }
+    }
+    return *slot;
+}
+
+} // namespace
+
+BENCH_ARGS(book_index_build, {100000, 1000000}) {
+    int books = (int)state.arg();
+    // Books made once up front: pausing the timer around each one would
+    // cost more than the add() being measured
+    state.pauseTiming();
+    Corpus corpus;
+    std::vector<Book> input;
+    input.reserve(books);
+    for (int i = 0; i < books; i++) input.emplace_back(corpus.title(), corpus.author());
+    state.resumeTiming();
+    size_t bytes = 0;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        BookIndex index;
+        for (const Book& b : input) index.add(b);
+        bytes = index.getMemoryBytes();
+    }
+    state.setItemsPerIteration(books);
+    state.setCounter("index_MB_per_1M_books", bytes / 1e6 * (1e6 / books));
+}
+
+BENCH_ARGS(book_index_query_top10, {100000, 1000000}) {
+    state.pauseTiming(); // first call builds the catalog
+    Catalog& c = catalog((int)state.arg());
+    state.resumeTiming();
+    size_t hits = 0;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        hits += c.index.search(c.queries[i % c.queries.size()], 10).size();
+    }
+    bench::doNotOptimize(hits);
+    state.setItemsPerIteration(1); // items/s = queries/s
+    state.setCounter("postings_MB_per_1M_books", c.index.getPostingBytes() / 1e6 * (1e6 / state.arg()));
+    state.setCounter("index_MB_per_1M_books", c.index.getMemoryBytes() / 1e6 * (1e6 / state.arg()));
+}
+
+// what a keyword search cost before the index: scan every record
+BENCH_ARGS(book_substring_scan, {100000}) {
+    state.pauseTiming();
+    Catalog& c = catalog((int)state.arg());
+    state.resumeTiming();
+    size_t hits = 0;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        std::vector<std::string> words = BookIndex::tokenize(c.queries[i % c.queries.size()]);
+        for (size_t b = 0; b < c.titles.size(); b++) {
+            bool all = true;
+            for (auto& w : words) {
+                if (c.titles[b].find(w) == std::string::npos && c.authors[b].find(w) == std::string::npos) {
+                    all = false;
+                    break;
+                }
+            }
+            hits += all;
+        }
+    }
+    bench::doNotOptimize(hits);
+    state.setItemsPerIteration(1);
+}
+
+template <bool Simd>
+static void intersectCase(bench::State& state) {
+    std::mt19937 rng(5);
+    std::vector<uint32_t> a, b, out(1 << 16);
+    for (uint32_t v = 0; a.size() < (1 << 16); v++) if (rng() % 4 == 0) a.push_back(v);
+    for (uint32_t v = 0; b.size() < (1 << 16); v++) if (rng() % 4 == 0) b.push_back(v);
+    size_t n = 0;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        n = Simd ? intersectSimd(a.data(), a.size(), b.data(), b.size(), out.data())
+                 : intersectScalar(a.data(), a.size(), b.data(), b.size(), out.data());
+        bench::doNotOptimize(out.data());
+    }
+    state.setItemsPerIteration(a.size() + b.size());
+    state.setCounter("matches", (double)n);
+}
+
+BENCH(intersect_scalar_64k) {
+    intersectCase<false>(state);
+}
+
+BENCH(intersect_simd_64k) {
+    intersectCase<true>(state);
+}
@@ -0,0 +1,22 @@
+#include <memory>
+#include <string>
+
+#include "box.h"
+#include "harness.h"
+
+BENCH(box_int_get) {
+    Box<int> b(123);
+    long long total = 0;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        bench::doNotOptimize(b);
+        total += b.getValue();
+    }
+    bench::doNotOptimize(total);
+}
+
+BENCH(box_string_make_unique) {
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        auto b = std::make_unique<Box<std::string>>("Hello, Templates! (long enough to allocate)");
+        bench::doNotOptimize(b->getValue().size());
+    }
+}
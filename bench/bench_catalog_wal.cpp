@@ -0,0 +1,103 @@
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catalog.h"
+#include "harness.h"
+
+// Commits go to a scratch directory under $PRACTICE_BENCH_DIR (default:
+// the current directory) so the numbers reflect the local disk, not a
+// tmpfs /tmp.
+namespace {
+
+std::string makeScratchDir() {
+    const char* base = std::getenv("PRACTICE_BENCH_DIR");
+    std::string templ = std::string(base && *base ? base : ".") + "/practice_wal.XXXXXX";
+    if (!mkdtemp(&templ[0])) {
+        std::perror("mkdtemp");
+        std::exit(2);
+    }
+    return templ;
+}
+
+void removeScratchDir(const std::string& dir) {
+    std::remove((dir + "/wal.log").c_str());
+    std::remove((dir + "/catalog.snap").c_str());
+    std::remove((dir + "/catalog.snap.tmp").c_str());
+    rmdir(dir.c_str());
+}
+
+// each iteration is one durable addBook; arg = concurrent writer threads
+void commitCase(bench::State& state, int commitWindowUs) {
+    int threads = (int)state.arg();
+    state.pauseTiming();
+    std::string dir = makeScratchDir();
+    LibraryCatalog::Options opt;
+    opt.log.commitWindowUs = commitWindowUs;
+    auto catalog = LibraryCatalog::open(dir, Library("Bench Library", "1 Disk Way"), opt);
+    std::vector<std::vector<double>> latencies(threads);
+    state.resumeTiming();
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; t++) {
+        writers.emplace_back([&, t] {
+            uint64_t mine = state.iterations() / threads + (t < (int)(state.iterations() % threads));
+            for (uint64_t i = 0; i < mine; i++) {
+                auto begin = std::chrono::steady_clock::now();
+                catalog->addBook(Book("Write-Ahead Logging", "Writer " + std::to_string(t)));
+                latencies[t].push_back(std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - begin).count());
+            }
+        });
+    }
+    for (auto& w : writers) w.join();
+
+    state.pauseTiming();
+    std::vector<double> all;
+    for (auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+    std::sort(all.begin(), all.end());
+    if (!all.empty()) {
+        state.setCounter("p50_us", all[all.size() / 2]);
+        state.setCounter("p99_us", all[std::min(all.size() - 1, all.size() * 99 / 100)]);
+        state.setCounter("commits_per_fsync", (double)all.size() / std::max<uint64_t>(catalog->getGroupCount(), 1));
+    }
+    catalog.reset();
+    removeScratchDir(dir);
+    state.resumeTiming();
+    state.setItemsPerIteration(1); // items/s = commits/s
+}
+
+} // namespace
+
+BENCH_ARGS(catalog_commit, {1, 4, 16, 64}) {
+    commitCase(state, 0);
+}
+
+BENCH_ARGS(catalog_commit_window_200us, {1, 16, 64}) {
+    commitCase(state, 200);
+}
+
+// the alternative the log replaces: rewrite a full snapshot per change
+BENCH_ARGS(catalog_snapshot_per_change, {10000}) {
+    int books = (int)state.arg();
+    state.pauseTiming();
+    std::string dir = makeScratchDir();
+    auto catalog = LibraryCatalog::open(dir, Library("Bench Library", "1 Disk Way"), {});
+    for (int i = 0; i < books; i++) catalog->addBook(Book("Snapshot", "Writer"));
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        catalog->addBook(Book("Snapshot", "Writer"));
+        catalog->compact();
+    }
+    state.pauseTiming();
+    catalog.reset();
+    removeScratchDir(dir);
+    state.resumeTiming();
+    state.setItemsPerIteration(1);
+}
@@ -0,0 +1,52 @@
+#include "cow_vector.h"
+#include "harness.h"
+#include "vector.h"
+
+// Copy-heavy, read-mostly: every iteration copies a 64K-element vector,
+// reads 64 elements from the copy and writes to one copy in 16.
+static const int kElements = 1 << 16;
+static const int kReads = 64;
+static const int kWriteEvery = 16;
+
+template <typename V>
+static void copyReadMostly(bench::State& state) {
+    V src;
+    for (int k = 0; k < kElements; k++) src.push_back(k);
+    long long total = 0;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        V copy(src);
+        for (int r = 0; r < kReads; r++) {
+            total += copy.get((r * 1021) & (kElements - 1));
+        }
+        if (i % kWriteEvery == 0) copy.set(0, (int)i);
+        bench::doNotOptimize(copy);
+    }
+    bench::doNotOptimize(total);
+}
+
+BENCH(copy_read_mostly_eager_vector) {
+    copyReadMostly<Vector>(state);
+}
+
+BENCH(copy_read_mostly_cow_vector) {
+    copyReadMostly<CowVector>(state);
+}
+
+BENCH(copy_then_write_cow_vector) {
+    CowVector src;
+    for (int k = 0; k < kElements; k++) src.push_back(k);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        CowVector copy(src);
+        copy.set(0, (int)i); // always detaches: the COW worst case
+        bench::doNotOptimize(copy);
+    }
+}
+
+BENCH(cow_vector_make_unique_copy) {
+    CowVector src;
+    for (int k = 0; k < kElements; k++) src.push_back(k);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        CowVector copy = src.make_unique_copy();
+        bench::doNotOptimize(copy);
+    }
+}
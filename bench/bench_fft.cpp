@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "fft.h"
+#include "harness.h"
+
+// Transform throughput in the usual FFT flop convention: 5 n log2 n per
+// complex transform of size n, 2.5 n log2 n per real one, whatever the
+// algorithm actually does for that size. The items column of these cases
+// is that flop rate, so "3.10G/s" reads as 3.1 GFLOPS.
+//
+// Each iteration runs a forward and an inverse transform, so the data
+// stays bounded without re-copying the input inside the timed loop.
+namespace {
+
+double complexFlops(size_t n) {
+    return 5.0 * (double)n * std::log2((double)n);
+}
+
+SplitComplex noise(size_t n) {
+    std::mt19937 rng(36);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    SplitComplex x(n);
+    for (size_t i = 0; i < n; i++) {
+        x.re[i] = u(rng);
+        x.im[i] = u(rng);
+    }
+    return x;
+}
+
+void roundTrip(bench::State& state, ThreadPool& pool) {
+    state.pauseTiming();
+    size_t n = (size_t)state.arg();
+    auto plan = FftPlan::get(n);
+    SplitComplex x = noise(n);
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        plan->forward(x, pool);
+        plan->inverse(x, pool);
+        bench::clobberMemory();
+    }
+    state.setItemsPerIteration(2 * complexFlops(n));
+    if (plan->usesBluestein()) {
+        state.setCounter("bluestein", 1);
+    } else {
+        state.setCounter("stages", (double)plan->getFactors().size());
+    }
+}
+
+} // namespace
+
+BENCH_ARGS(fft_pow2_roundtrip, {64, 1024, 1 << 14, 1 << 16, 1 << 20, 1 << 22}) {
+    roundTrip(state, ThreadPool::shared());
+}
+
+// same sizes on a one-thread pool, to isolate what threading adds
+BENCH_ARGS(fft_pow2_roundtrip_single_thread, {1 << 16, 1 << 20, 1 << 22}) {
+    static ThreadPool single(1);
+    roundTrip(state, single);
+}
+
+// 1000 = 4*2*5^3, 59049 = 3^10, 100000 = 4^2*2*5^5: radix-4/2 plus generic odd radices
+BENCH_ARGS(fft_mixed_radix_roundtrip, {1000, 59049, 100000, 1000000}) {
+    roundTrip(state, ThreadPool::shared());
+}
+
+// primes, done with Bluestein's algorithm on a power-of-two plan
+BENCH_ARGS(fft_bluestein_roundtrip, {1009, 65537, 1000003}) {
+    roundTrip(state, ThreadPool::shared());
+}
+
+BENCH_ARGS(fft_real_roundtrip, {1024, 1 << 16, 1 << 20}) {
+    state.pauseTiming();
+    size_t n = (size_t)state.arg();
+    auto plan = RealFftPlan::get(n);
+    SplitComplex x = noise(n);
+    std::vector<float> binRe(plan->getBinCount()), binIm(plan->getBinCount());
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        plan->forward(x.re.data(), binRe.data(), binIm.data());
+        plan->inverse(binRe.data(), binIm.data(), x.re.data());
+        bench::clobberMemory();
+    }
+    state.setItemsPerIteration(complexFlops(n)); // 2 x 2.5 n log2 n
+}
+
+// the reference the plans are validated against, for scale
+BENCH_ARGS(dft_naive, {256, 1024}) {
+    state.pauseTiming();
+    size_t n = (size_t)state.arg();
+    SplitComplex x = noise(n);
+    std::vector<double> outRe(n), outIm(n);
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        naiveDft(x.re.data(), x.im.data(), n, outRe.data(), outIm.data());
+        bench::doNotOptimize(outRe.data());
+    }
+    state.setItemsPerIteration(complexFlops(n));
+}
+
+// forward transform checked against the double-precision naive DFT:
+// max_rel_error is the worst bin error relative to the largest bin
+BENCH_ARGS(fft_vs_naive_dft, {256, 1000, 1009, 4096}) {
+    state.pauseTiming();
+    size_t n = (size_t)state.arg();
+    auto plan = FftPlan::get(n);
+    SplitComplex x = noise(n);
+    std::vector<double> wantRe(n), wantIm(n);
+    naiveDft(x.re.data(), x.im.data(), n, wantRe.data(), wantIm.data());
+    SplitComplex y(n);
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        y = x;
+        plan->forward(y);
+        bench::clobberMemory();
+    }
+    double err = 0, peak = 0;
+    for (size_t k = 0; k < n; k++) {
+        err = std::max(err, std::hypot(y.re[k] - wantRe[k], y.im[k] - wantIm[k]));
+        peak = std::max(peak, std::hypot(wantRe[k], wantIm[k]));
+    }
+    state.setItemsPerIteration(complexFlops(n));
+    state.setCounter("max_rel_error", err / peak);
+}
@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "generator.h"
+#include "harness.h"
+#include "library.h"
+#include "points.h"
+#include "rcu_catalog.h"
+#include "stack.h"
+#include "task.h"
+#include "vector.h"
+
+// Eager pipelines (materialize every stage, as the existing code does)
+// against Generator pipelines over the same data.
+//
+// *_first cases stop at the first result, which is the latency a caller
+// waits before it can start work. Build with -DPRACTICE_TRACK_ALLOC=ON to
+// get peak_bytes: the largest amount of heap held above the starting
+// point during the case.
+namespace {
+
+int scramble(long i) {
+    return (int)(((uint64_t)i * 2654435761u) >> 8 & 0xffffff);
+}
+
+const Vector& numbers(int n) {
+    static std::map<int, std::unique_ptr<Vector>> cache;
+    auto& slot = cache[n];
+    if (!slot) {
+        slot = std::make_unique<Vector>(n);
+        for (int i = 0; i < n; i++) slot->push_back(scramble(i));
+    }
+    return *slot;
+}
+
+const std::vector<Book>& books(int n) {
+    static std::map<int, std::unique_ptr<std::vector<Book>>> cache;
+    auto& slot = cache[n];
+    if (!slot) {
+        slot = std::make_unique<std::vector<Book>>();
+        slot->reserve(n);
+        for (int i = 0; i < n; i++) {
+            slot->emplace_back("Title " + std::to_string(i), "Author " + std::to_string(i % 64));
+        }
+    }
+    return *slot;
+}
+
+const Stack<int>& pushes(int n) {
+    static std::map<int, std::unique_ptr<Stack<int>>> cache;
+    auto& slot = cache[n];
+    if (!slot) {
+        slot = std::make_unique<Stack<int>>();
+        for (int i = 0; i < n; i++) slot->push(scramble(i));
+    }
+    return *slot;
+}
+
+RcuCatalog& bookCatalog() {
+    static RcuCatalog catalog;
+    if (catalog.snapshot().getSize() == 0) {
+        for (const Book& b : books(1 << 16)) catalog.addBook(b);
+    }
+    return catalog;
+}
+
+std::string describe(const Book& b) {
+    std::ostringstream out;
+    b.display(out);
+    return out.str();
+}
+
+// the Vector pipeline: map v*3+1, keep multiples of 7, batches of 256,
+// then sum each batch
+const int kBatch = 256;
+
+long mapped(int v) { return (long)v * 3 + 1; }
+bool keep(long v) { return v % 7 == 0; }
+
+std::vector<std::vector<long>> eagerBatches(const Vector& v) {
+    std::vector<long> m;
+    for (int x : v) m.push_back(mapped(x));
+    std::vector<long> f;
+    for (long x : m) {
+        if (keep(x)) f.push_back(x);
+    }
+    std::vector<std::vector<long>> batches;
+    for (size_t i = 0; i < f.size(); i += kBatch) {
+        batches.emplace_back(f.begin() + i, f.begin() + std::min(f.size(), i + kBatch));
+    }
+    return batches;
+}
+
+Generator<std::vector<long>> lazyBatches(const Vector& v) {
+    return lazy::values(v) | lazy::map(mapped) | lazy::filter(keep) | lazy::batch(kBatch);
+}
+
+long sumOf(const std::vector<long>& batch) {
+    long s = 0;
+    for (long x : batch) s += x;
+    return s;
+}
+
+Task<void> consumeBatch(const std::vector<long>& batch, long& total) {
+    total += sumOf(batch);
+    co_return;
+}
+
+} // namespace
+
+#define VECTOR_SIZES {1 << 20, 1 << 24}
+
+BENCH_ARGS(vector_pipeline_eager, VECTOR_SIZES) {
+    state.pauseTiming();
+    const Vector& v = numbers((int)state.arg());
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        long total = 0;
+        for (const auto& b : eagerBatches(v)) total += sumOf(b);
+        bench::doNotOptimize(total);
+    }
+    state.setItemsPerIteration(state.arg());
+}
+
+BENCH_ARGS(vector_pipeline_lazy, VECTOR_SIZES) {
+    state.pauseTiming();
+    const Vector& v = numbers((int)state.arg());
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        long total = 0;
+        for (const auto& b : lazyBatches(v)) total += sumOf(b);
+        bench::doNotOptimize(total);
+    }
+    state.setItemsPerIteration(state.arg());
+}
+
+// batches handed to an async consumer Task, awaited one at a time
+BENCH_ARGS(vector_pipeline_async, VECTOR_SIZES) {
+    state.pauseTiming();
+    const Vector& v = numbers((int)state.arg());
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        long total = 0;
+        syncWait(lazy::forEachAsync(lazyBatches(v), [&](const std::vector<long>& b) { return consumeBatch(b, total); }));
+        bench::doNotOptimize(total);
+    }
+    state.setItemsPerIteration(state.arg());
+}
+
+BENCH_ARGS(vector_pipeline_eager_first, VECTOR_SIZES) {
+    state.pauseTiming();
+    const Vector& v = numbers((int)state.arg());
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        auto batches = eagerBatches(v);
+        bench::doNotOptimize(sumOf(batches.front()));
+    }
+}
+
+BENCH_ARGS(vector_pipeline_lazy_first, VECTOR_SIZES) {
+    state.pauseTiming();
+    const Vector& v = numbers((int)state.arg());
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        auto batches = lazyBatches(v);
+        bench::doNotOptimize(sumOf(*batches.begin()));
+    }
+}
+
+// Book::display formats straight away; here the first 20 books by one
+// author are formatted, eagerly (format every match, then keep 20) or lazily
+#define BOOK_COUNTS {1 << 16, 1 << 20}
+static const size_t kBookResults = 20;
+
+BENCH_ARGS(books_first_matches_eager, BOOK_COUNTS) {
+    state.pauseTiming();
+    const std::vector<Book>& all = books((int)state.arg());
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        std::vector<std::string> lines;
+        for (const Book& b : all) {
+            if (b.getAuthor() == "Author 7") lines.push_back(describe(b));
+        }
+        lines.resize(std::min(lines.size(), kBookResults));
+        bench::doNotOptimize(lines.data());
+    }
+}
+
+BENCH_ARGS(books_first_matches_lazy, BOOK_COUNTS) {
+    state.pauseTiming();
+    const std::vector<Book>& all = books((int)state.arg());
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        auto lines = lazy::collect(lazy::values(all)
+            | lazy::filter([](const Book& b) { return b.getAuthor() == "Author 7"; })
+            | lazy::map(describe)
+            | lazy::take(kBookResults));
+        bench::doNotOptimize(lines.data());
+    }
+}
+
+// the same query against an RcuCatalog snapshot
+BENCH(catalog_first_matches_eager) {
+    state.pauseTiming();
+    RcuCatalog& catalog = bookCatalog();
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        auto snap = catalog.snapshot();
+        std::vector<CatalogEntry> hits;
+        snap.forEach([&](const CatalogEntry& e) {
+            if (e.author == "Author 7") hits.push_back(e);
+        });
+        hits.resize(std::min(hits.size(), kBookResults));
+        bench::doNotOptimize(hits.data());
+    }
+}
+
+BENCH(catalog_first_matches_lazy) {
+    state.pauseTiming();
+    RcuCatalog& catalog = bookCatalog();
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        auto snap = catalog.snapshot();
+        auto hits = lazy::collect(snap.entries()
+            | lazy::filter([](const CatalogEntry& e) { return e.author == "Author 7"; })
+            | lazy::take(kBookResults));
+        bench::doNotOptimize(hits.data());
+    }
+}
+
+// the ten most recent pushes that are even: eager pops a copy of the
+// stack into a vector first, lazy walks it from the top
+BENCH_ARGS(stack_recent_matches_eager, {1 << 20}) {
+    state.pauseTiming();
+    const Stack<int>& stack = pushes((int)state.arg());
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        Stack<int> copy = stack;
+        std::vector<int> all;
+        while (!copy.empty()) {
+            all.push_back(copy.top());
+            copy.pop();
+        }
+        std::vector<int> hits;
+        for (int v : all) {
+            if (v % 2 == 0 && hits.size() < 10) hits.push_back(v);
+        }
+        bench::doNotOptimize(hits.data());
+    }
+}
+
+BENCH_ARGS(stack_recent_matches_lazy, {1 << 20}) {
+    state.pauseTiming();
+    const Stack<int>& stack = pushes((int)state.arg());
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        auto hits = lazy::collect(stack.walk() | lazy::filter([](int v) { return v % 2 == 0; }) | lazy::take(10));
+        bench::doNotOptimize(hits.data());
+    }
+}
+
+// day 1's findMaxInArray needs the values in an array first; a fold over
+// a generated stream needs none
+BENCH_ARGS(reduce_max_eager, VECTOR_SIZES) {
+    int n = (int)state.arg();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        std::vector<int> values(n);
+        for (int j = 0; j < n; j++) values[j] = scramble(j);
+        bench::doNotOptimize(findMaxInArray(values.data(), n));
+    }
+    state.setItemsPerIteration(n);
+}
+
+BENCH_ARGS(reduce_max_lazy, VECTOR_SIZES) {
+    long n = state.arg();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        int best = lazy::fold(lazy::range(0, n) | lazy::map(scramble), 0, [](int a, int b) { return std::max(a, b); });
+        bench::doNotOptimize(best);
+    }
+    state.setItemsPerIteration(n);
+}
@@ -0,0 +1,44 @@
+#include <sstream>
+#include <string>
+
+#include "harness.h"
+#include "library.h"
+#include "stack.h"
+
+BENCH(complex_add) {
+    Complex acc(0, 0);
+    Complex step(0.5f, -0.25f);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        acc = acc + step;
+        bench::doNotOptimize(acc);
+    }
+}
+
+BENCH(book_construct) {
+    const std::string title = "The C++ Programming Language";
+    const std::string author = "Bjarne Stroustrup";
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        Book b(title, author);
+        bench::doNotOptimize(b.getId());
+    }
+}
+
+BENCH(book_display) {
+    Magazine m("Practice Weekly", "Staff", 12);
+    std::ostringstream out;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        out.str("");
+        m.display(out);
+    }
+    bench::doNotOptimize(out.tellp());
+}
+
+BENCH(stack_push_pop) {
+    const int depth = 1024;
+    Stack<int> s;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        for (int k = 0; k < depth; k++) s.push(k);
+        while (!s.empty()) s.pop();
+    }
+    state.setItemsPerIteration(depth);
+}
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "harness.h"
+#include "point_store.h"
+
+// Clustered points (Gaussian blobs) in [-16000, 16000]^2, small enough
+// that distance() stays inside int. Compares a plain vector<Point> in
+// arbitrary order with the Morton-sorted compressed PointStore.
+namespace {
+
+std::vector<Point> clusteredPoints(size_t n) {
+    std::mt19937 rng(2024);
+    std::uniform_int_distribution<int> centre(-15000, 15000);
+    std::normal_distribution<double> spread(0.0, 300.0);
+    std::vector<Point> pts(n);
+    Point c = {0, 0};
+    for (size_t i = 0; i < n; i++) {
+        if (i % 4096 == 0) c = {centre(rng), centre(rng)};
+        int x = std::clamp((int)(c.x + spread(rng)), -16000, 16000);
+        int y = std::clamp((int)(c.y + spread(rng)), -16000, 16000);
+        pts[i] = {x, y};
+    }
+    std::shuffle(pts.begin(), pts.end(), rng); // arrival order, not spatial order
+    return pts;
+}
+
+struct Data {
+    std::vector<Point> plain;
+    PointStore store;
+};
+
+Data& data(size_t n) {
+    static std::map<size_t, std::unique_ptr<Data>> cache;
+    auto& slot = cache[n];
+    if (!slot) {
+        slot = std::make_unique<Data>();
+        slot->plain = clusteredPoints(n);
+        slot->store = PointStore(slot->plain);
+    }
+    return *slot;
+}
+
+void setSizes(bench::State& state, const Data& d) {
+    state.setCounter("bytes_per_point", d.store.getBytesPerPoint());
+    state.setCounter("plain_bytes_per_point", (double)sizeof(Point));
+}
+
+} // namespace
+
+#define POINT_COUNTS {1 << 20, 1 << 24}
+
+BENCH_ARGS(points_sweep_plain_vector, POINT_COUNTS) {
+    state.pauseTiming();
+    Data& d = data(state.arg());
+    state.resumeTiming();
+    Point origin = {0, 0};
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        long long total = 0;
+        for (const Point& p : d.plain) total += distance(origin, p);
+        bench::doNotOptimize(total);
+    }
+    state.setItemsPerIteration((double)d.plain.size());
+    setSizes(state, d);
+}
+
+BENCH_ARGS(points_sweep_morton_store, POINT_COUNTS) {
+    state.pauseTiming();
+    Data& d = data(state.arg());
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        bench::doNotOptimize(d.store.distanceSweep({0, 0}));
+    }
+    state.setItemsPerIteration((double)d.store.getSize());
+    setSizes(state, d);
+}
+
+// neighbourhood query: points within 500 units of a random cluster point
+BENCH_ARGS(points_radius_query_plain_vector, POINT_COUNTS) {
+    state.pauseTiming();
+    Data& d = data(state.arg());
+    state.resumeTiming();
+    size_t found = 0;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        Point c = d.plain[(i * 7919) % d.plain.size()];
+        for (const Point& p : d.plain) found += distance(c, p) <= 500 * 500;
+    }
+    bench::doNotOptimize(found);
+    setSizes(state, d);
+}
+
+BENCH_ARGS(points_radius_query_morton_store, POINT_COUNTS) {
+    state.pauseTiming();
+    Data& d = data(state.arg());
+    state.resumeTiming();
+    size_t found = 0;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        found += d.store.countWithin(d.plain[(i * 7919) % d.plain.size()], 500 * 500);
+    }
+    bench::doNotOptimize(found);
+    setSizes(state, d);
+}
+
+BENCH_ARGS(points_morton_store_build, {1 << 20}) {
+    state.pauseTiming();
+    std::vector<Point> pts = clusteredPoints(state.arg());
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        PointStore s(pts);
+        bench::doNotOptimize(s.getBytes());
+    }
+    state.setItemsPerIteration((double)pts.size());
+}
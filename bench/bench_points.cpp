@@ -0,0 +1,54 @@
+#include <random>
+#include <vector>
+
+#include "harness.h"
+#include "points.h"
+
+static const int kArraySize = 1 << 16;
+
+static std::vector<int> randomInts(int n) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(-1000, 1000);
+    std::vector<int> v(n);
+    for (int& x : v) x = dist(rng);
+    return v;
+}
+
+BENCH(points_sum_array) {
+    std::vector<int> v = randomInts(kArraySize);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        bench::doNotOptimize(sumArray(v.data(), kArraySize));
+    }
+    state.setItemsPerIteration(kArraySize);
+}
+
+BENCH(points_find_max) {
+    std::vector<int> v = randomInts(kArraySize);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        bench::doNotOptimize(findMaxInArray(v.data(), kArraySize));
+    }
+    state.setItemsPerIteration(kArraySize);
+}
+
+BENCH(points_swap) {
+    int a = 1, b = 2;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        swapReferences(a, b);
+        swapPointer(&a, &b);
+        bench::clobberMemory();
+    }
+    bench::doNotOptimize(a);
+}
+
+BENCH(points_distance_sweep) {
+    std::vector<int> coords = randomInts(2 * kArraySize);
+    std::vector<Point> pts(kArraySize);
+    for (int i = 0; i < kArraySize; i++) pts[i] = {coords[2 * i], coords[2 * i + 1]};
+    Point origin = {0, 0};
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        long long total = 0;
+        for (const Point& p : pts) total += distance(origin, p);
+        bench::doNotOptimize(total);
+    }
+    state.setItemsPerIteration(kArraySize);
+}
@@ -0,0 +1,93 @@
+#include <atomic>
+#include <map>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "harness.h"
+#include "rcu_catalog.h"
+
+// Read scaling with one writer: arg = reader threads. Each iteration is
+// one lookup by a random id; the writer keeps adding Books until all
+// readers are done. items/s = lookups/s across all readers.
+namespace {
+
+const int kInitialBooks = 100000;
+#define READER_COUNTS {1, 2, 4, 8, 16, 32, 64}
+
+// the reader-writer-lock catalog the RCU one replaces
+class LockedCatalog {
+    mutable std::shared_mutex mutex;
+    std::map<int, CatalogEntry> entries;
+public:
+    void addBook(const Book& b) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        entries[b.getId()] = {b.getId(), b.getTitle(), b.getAuthor(), -1};
+    }
+    size_t titleLength(int id) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = entries.find(id);
+        return it == entries.end() ? 0 : it->second.title.size();
+    }
+};
+
+size_t titleLength(const RcuCatalog& c, int id) {
+    RcuCatalog::Snapshot s = c.snapshot();
+    const CatalogEntry* e = s.find(id);
+    return e ? e->title.size() : 0;
+}
+
+size_t titleLength(const LockedCatalog& c, int id) {
+    return c.titleLength(id);
+}
+
+template <typename Catalog>
+void readScaling(bench::State& state) {
+    int readers = (int)state.arg();
+    state.pauseTiming();
+    Catalog catalog;
+    int firstId = Book::getBookCount() + 1;
+    for (int i = 0; i < kInitialBooks; i++) catalog.addBook(Book("Read Mostly", "Many Readers"));
+    state.resumeTiming();
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> writes{0};
+    std::thread writer([&] {
+        while (!done.load(std::memory_order_relaxed)) {
+            catalog.addBook(Book("Fresh Arrival", "Writer"));
+            writes.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    std::vector<std::thread> threads;
+    std::atomic<size_t> checksum{0};
+    for (int r = 0; r < readers; r++) {
+        threads.emplace_back([&, r] {
+            uint64_t mine = state.iterations() / readers + (r < (int)(state.iterations() % readers));
+            std::mt19937 rng(r);
+            size_t sum = 0;
+            for (uint64_t i = 0; i < mine; i++) {
+                sum += titleLength(catalog, firstId + (int)(rng() % kInitialBooks));
+            }
+            checksum += sum;
+        });
+    }
+    for (auto& t : threads) t.join();
+    done = true;
+    writer.join();
+
+    bench::doNotOptimize(checksum.load());
+    state.setItemsPerIteration(1);
+    state.setCounter("writes", (double)writes.load());
+}
+
+} // namespace
+
+BENCH_ARGS(rcu_catalog_read_1_writer, READER_COUNTS) {
+    readScaling<RcuCatalog>(state);
+}
+
+BENCH_ARGS(rwlock_catalog_read_1_writer, READER_COUNTS) {
+    readScaling<LockedCatalog>(state);
+}
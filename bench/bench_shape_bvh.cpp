@@ -0,0 +1,181 @@
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "harness.h"
+#include "shape_bvh.h"
+
+// A large scene of circles, rectangles and squares scattered at constant
+// density (about one shape per 400 square units), seen through a
+// 1920x1080 viewport that pans a little each frame. Compares drawing
+// everything with drawing only what the BVH says is visible.
+namespace {
+
+struct Scene {
+    std::vector<std::unique_ptr<Shape>> shapes;
+    std::vector<Shape*> pointers;
+    double extent; // the world is [0, extent]^2
+};
+
+Scene makeScene(size_t n) {
+    std::mt19937 rng(35);
+    Scene s;
+    s.extent = std::sqrt((double)n * 400.0);
+    std::uniform_real_distribution<double> pos(0.0, s.extent);
+    std::uniform_real_distribution<double> size(0.5, 10.0);
+    for (size_t i = 0; i < n; i++) {
+        double x = pos(rng), y = pos(rng);
+        switch (i % 3) {
+        case 0: s.shapes.push_back(std::make_unique<Circle>(size(rng), x, y)); break;
+        case 1: s.shapes.push_back(std::make_unique<Rectangle>(size(rng), size(rng), x, y)); break;
+        default: s.shapes.push_back(std::make_unique<Square>(size(rng), x, y)); break;
+        }
+        s.pointers.push_back(s.shapes.back().get());
+    }
+    return s;
+}
+
+Scene& scene(size_t n) {
+    static std::map<size_t, std::unique_ptr<Scene>> cache;
+    auto& slot = cache[n];
+    if (!slot) slot = std::make_unique<Scene>(makeScene(n));
+    return *slot;
+}
+
+Aabb viewport(const Scene& s, uint64_t frame) {
+    double x = s.extent / 2 + (double)(frame % 64) * 8;
+    double y = s.extent / 2;
+    return {x - 960, y - 540, x + 960, y + 540};
+}
+
+} // namespace
+
+#define SCENE_SIZES {1 << 16, 1 << 20}
+
+BENCH_ARGS(scene_frame_draw_all, SCENE_SIZES) {
+    state.pauseTiming();
+    Scene& s = scene(state.arg());
+    state.resumeTiming();
+    bench::MuteCout mute; // draw() formats every frame, the text is dropped
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        for (Shape* shape : s.pointers) shape->draw();
+    }
+    state.setCounter("drawn", (double)s.pointers.size());
+}
+
+BENCH_ARGS(scene_frame_draw_culled, SCENE_SIZES) {
+    state.pauseTiming();
+    Scene& s = scene(state.arg());
+    ShapeBvh bvh(s.pointers);
+    state.resumeTiming();
+    bench::MuteCout mute; // draw() formats every frame, the text is dropped
+    size_t drawn = 0;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        drawn = bvh.drawVisible(viewport(s, i));
+    }
+    state.setCounter("drawn", (double)drawn);
+}
+
+BENCH_ARGS(scene_bvh_build, SCENE_SIZES) {
+    state.pauseTiming();
+    Scene& s = scene(state.arg());
+    state.resumeTiming();
+    double cost = 0;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        ShapeBvh bvh(s.pointers);
+        cost = bvh.getSahCost();
+        bench::doNotOptimize(cost);
+    }
+    state.setItemsPerIteration(s.pointers.size());
+    state.setCounter("sah_cost", cost);
+}
+
+// every shape drifts by up to one unit per frame along a fixed heading;
+// the tree is refit, not rebuilt, and sah_growth shows how much quality
+// that gave up over the frames run
+BENCH_ARGS(scene_bvh_move_and_refit, SCENE_SIZES) {
+    state.pauseTiming();
+    Scene s = makeScene(state.arg());
+    ShapeBvh bvh(s.pointers);
+    double built = bvh.getSahCost();
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> step(-1.0, 1.0);
+    std::vector<double> dx(s.pointers.size()), dy(s.pointers.size());
+    for (size_t j = 0; j < dx.size(); j++) {
+        dx[j] = step(rng);
+        dy[j] = step(rng);
+    }
+    state.resumeTiming();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        for (size_t j = 0; j < s.pointers.size(); j++) {
+            Shape* shape = s.pointers[j];
+            shape->setPosition(shape->getX() + dx[j], shape->getY() + dy[j]);
+        }
+        bvh.refit();
+    }
+    state.setItemsPerIteration(s.pointers.size());
+    state.setCounter("frames", (double)state.iterations());
+    state.setCounter("sah_growth", bvh.getSahCost() / built);
+}
+
+static const int kPicks = 1024;
+static const int kLinearPicks = 16; // a linear scan of 1M shapes per pick is slow
+
+BENCH_ARGS(scene_pick_point_linear, SCENE_SIZES) {
+    state.pauseTiming();
+    Scene& s = scene(state.arg());
+    state.resumeTiming();
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> pos(0.0, s.extent);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        for (int p = 0; p < kLinearPicks; p++) {
+            double x = pos(rng), y = pos(rng);
+            Shape* hit = nullptr;
+            for (size_t j = s.pointers.size(); j-- > 0;) {
+                if (s.pointers[j]->contains(x, y)) {
+                    hit = s.pointers[j];
+                    break;
+                }
+            }
+            bench::doNotOptimize(hit);
+        }
+    }
+    state.setItemsPerIteration(kLinearPicks);
+}
+
+BENCH_ARGS(scene_pick_point_bvh, SCENE_SIZES) {
+    state.pauseTiming();
+    Scene& s = scene(state.arg());
+    ShapeBvh bvh(s.pointers);
+    state.resumeTiming();
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> pos(0.0, s.extent);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        for (int p = 0; p < kPicks; p++) {
+            Shape* hit = bvh.pickPoint(pos(rng), pos(rng));
+            bench::doNotOptimize(hit);
+        }
+    }
+    state.setItemsPerIteration(kPicks);
+}
+
+BENCH_ARGS(scene_pick_rect_bvh, SCENE_SIZES) {
+    state.pauseTiming();
+    Scene& s = scene(state.arg());
+    ShapeBvh bvh(s.pointers);
+    state.resumeTiming();
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> pos(0.0, s.extent - 100);
+    std::vector<Shape*> hits;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        for (int p = 0; p < kPicks; p++) {
+            double x = pos(rng), y = pos(rng);
+            hits.clear();
+            bvh.pickRect({x, y, x + 100, y + 100}, hits);
+            bench::doNotOptimize(hits.data());
+        }
+    }
+    state.setItemsPerIteration(kPicks);
+}
@@ -0,0 +1,43 @@
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "harness.h"
+#include "shapes.h"
+
+static const int kShapes = 1 << 14;
+
+static std::vector<std::unique_ptr<Shape>> makeScene() {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> size(0.5, 10.0);
+    std::vector<std::unique_ptr<Shape>> scene;
+    for (int i = 0; i < kShapes; i++) {
+        switch (i % 3) {
+        case 0: scene.push_back(std::make_unique<Circle>(size(rng))); break;
+        case 1: scene.push_back(std::make_unique<Rectangle>(size(rng), size(rng))); break;
+        default: scene.push_back(std::make_unique<Square>(size(rng))); break;
+        }
+    }
+    return scene;
+}
+
+BENCH(shapes_total_area) {
+    auto scene = makeScene();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        double total = 0;
+        for (auto& s : scene) total += s->area();
+        bench::doNotOptimize(total);
+    }
+    state.setItemsPerIteration(kShapes);
+}
+
+// draw() writes to std::cout; send it to a discarding buffer so the case
+// measures formatting, not the terminal
+BENCH(shapes_draw) {
+    auto scene = makeScene();
+    bench::MuteCout mute;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        for (auto& s : scene) s->draw();
+    }
+    state.setItemsPerIteration(kShapes);
+}
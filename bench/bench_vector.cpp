@@ -0,0 +1,51 @@
+#include "harness.h"
+#include "vector.h"
+
+static const int kElements = 1 << 16;
+
+BENCH(vector_push_back) {
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        Vector v;
+        for (int k = 0; k < kElements; k++) v.push_back(k);
+        bench::doNotOptimize(v.getSize());
+    }
+    state.setItemsPerIteration(kElements);
+}
+
+BENCH(vector_push_back_reserved) {
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        Vector v(kElements);
+        for (int k = 0; k < kElements; k++) v.push_back(k);
+        bench::doNotOptimize(v.getSize());
+    }
+    state.setItemsPerIteration(kElements);
+}
+
+BENCH(vector_copy) {
+    Vector src;
+    for (int k = 0; k < kElements; k++) src.push_back(k);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        Vector copy(src);
+        bench::doNotOptimize(copy.get(kElements - 1));
+    }
+    state.setItemsPerIteration(kElements);
+}
+
+BENCH(vector_copy_assign) {
+    Vector src, dst;
+    for (int k = 0; k < kElements; k++) src.push_back(k);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        dst = src;
+        bench::doNotOptimize(dst.get(kElements - 1));
+    }
+    state.setItemsPerIteration(kElements);
+}
+
+BENCH(vector_push_pop) {
+    Vector v(1024);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        v.push_back((int)i);
+        v.pop_back();
+    }
+    bench::doNotOptimize(v.getSize());
+}
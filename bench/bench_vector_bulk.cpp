@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "harness.h"
+#include "parallel.h"
+#include "vector.h"
+
+// 1e8 is the size the bulk APIs were written for; it needs --max-arg 0
+#define BULK_SIZES {1 << 20, 100000000}
+
+static std::vector<int> randomInts(long n) {
+    std::mt19937 rng(1234);
+    std::vector<int> v(n);
+    for (int& x : v) x = (int)rng();
+    return v;
+}
+
+BENCH_ARGS(vector_fill_push_back, BULK_SIZES) {
+    int n = (int)state.arg();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        Vector v;
+        for (int k = 0; k < n; k++) v.push_back(k);
+        bench::doNotOptimize(v.getSize());
+    }
+    state.setItemsPerIteration(n);
+}
+
+BENCH_ARGS(vector_fill_append_span, BULK_SIZES) {
+    int n = (int)state.arg();
+    std::vector<int> src(n);
+    std::iota(src.begin(), src.end(), 0);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        Vector v;
+        v.append(src);
+        bench::doNotOptimize(v.getSize());
+    }
+    state.setItemsPerIteration(n);
+}
+
+// sized once, then written in place: the fill the other cases do, minus
+// per-element capacity checks
+BENCH_ARGS(vector_fill_resize_uninitialized, BULK_SIZES) {
+    int n = (int)state.arg();
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        Vector v;
+        v.resize_uninitialized(n);
+        int* p = v.begin();
+        for (int k = 0; k < n; k++) p[k] = k;
+        bench::doNotOptimize(v.begin());
+    }
+    state.setItemsPerIteration(n);
+}
+
+template <typename SortFn>
+static void sortCase(bench::State& state, SortFn sortFn) {
+    int n = (int)state.arg();
+    std::vector<int> src = randomInts(n);
+    Vector v;
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        state.pauseTiming();
+        v.clear();
+        v.append(src);
+        state.resumeTiming();
+        sortFn(v);
+        bench::doNotOptimize(v.begin());
+    }
+    state.setItemsPerIteration(n);
+    state.setCounter("threads", ThreadPool::shared().getThreadCount());
+}
+
+BENCH_ARGS(vector_sort_std, BULK_SIZES) {
+    sortCase(state, [](Vector& v) { std::sort(v.begin(), v.end()); });
+}
+
+BENCH_ARGS(vector_sort_parallel, BULK_SIZES) {
+    sortCase(state, [](Vector& v) { parallel::sort(v); });
+}
+
+BENCH_ARGS(vector_reduce_parallel, BULK_SIZES) {
+    int n = (int)state.arg();
+    Vector v;
+    v.append(randomInts(n));
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        bench::doNotOptimize(parallel::reduce(v, 0LL));
+    }
+    state.setItemsPerIteration(n);
+}
+
+BENCH_ARGS(vector_transform_parallel, BULK_SIZES) {
+    int n = (int)state.arg();
+    Vector v;
+    v.resize(n, 1);
+    for (uint64_t i = 0; i < state.iterations(); i++) {
+        parallel::transform(v, [](int x) { return x * 3 + 1; });
+        bench::doNotOptimize(v.begin());
+    }
+    state.setItemsPerIteration(n);
+}
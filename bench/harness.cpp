@@ -0,0 +1,335 @@
+#include "harness.h"
+
+#include "alloc_tracker.h"
+#include "instrument.h"
+
+#include <sched.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+namespace bench {
+
+namespace {
+
+struct Case {
+    std::string name;
+    BenchFn fn;
+    int64_t arg;
+};
+
+std::vector<Case>& cases() {
+    static std::vector<Case> all;
+    return all;
+}
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Options {
+    std::string filter;
+    int reps = 5;
+    double minTime = 0.1; // seconds per repetition
+    double warmup = 0.05; // seconds
+    int cpu = -1; // -1 = don't pin
+    std::string saveBaseline;
+    std::string compare;
+    std::string instrJson;
+    std::string trace;
+    double threshold = 5.0; // percent slowdown that counts as a regression
+    int64_t maxArg = 1 << 24; // skip bigger BENCH_ARGS sizes unless asked
+    bool list = false;
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations;
+    double medianNs, meanNs, stddevNs, minNs;
+    double items;
+    std::vector<std::pair<std::string, double>> counters;
+};
+
+void usage(const char* prog) {
+    std::cerr << "usage: " << prog << " [options]\n"
+              << "  --filter STR         only run cases whose name contains STR\n"
+              << "  --reps N             measured repetitions per case (default 5)\n"
+              << "  --min-time SEC       minimum time per repetition (default 0.1)\n"
+              << "  --warmup SEC         warm-up time per case (default 0.05)\n"
+              << "  --cpu N              pin the benchmark thread to CPU N\n"
+              << "  --save-baseline FILE write medians to FILE\n"
+              << "  --compare FILE       compare medians against FILE, exit 1 on regression\n"
+              << "  --threshold PCT      slowdown that counts as a regression (default 5)\n"
+              << "  --instr-json FILE    write INSTR_* counters and histograms to FILE\n"
+              << "  --trace FILE         write INSTR_SCOPE spans to FILE (Chrome trace format)\n"
+              << "  --max-arg N          skip cases whose size argument exceeds N\n"
+              << "                       (default 16777216, 0 = no limit)\n"
+              << "  --list               list case names and exit\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::cerr << "missing value for " << a << "\n";
+                return nullptr;
+            }
+            return argv[++i];
+        };
+        const char* v = nullptr;
+        if (a == "--list") {
+            opt.list = true;
+            continue;
+        }
+        if (a == "--help" || a == "-h" || !(v = next())) return false;
+        if (a == "--filter") opt.filter = v;
+        else if (a == "--reps") opt.reps = std::max(1, std::atoi(v));
+        else if (a == "--min-time") opt.minTime = std::atof(v);
+        else if (a == "--warmup") opt.warmup = std::atof(v);
+        else if (a == "--cpu") opt.cpu = std::atoi(v);
+        else if (a == "--save-baseline") opt.saveBaseline = v;
+        else if (a == "--compare") opt.compare = v;
+        else if (a == "--instr-json") opt.instrJson = v;
+        else if (a == "--trace") opt.trace = v;
+        else if (a == "--threshold") opt.threshold = std::atof(v);
+        else if (a == "--max-arg") opt.maxArg = std::atoll(v);
+        else {
+            std::cerr << "unknown option " << a << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool pinToCpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+std::string formatNs(double ns) {
+    char buf[32];
+    if (ns < 1e3) std::snprintf(buf, sizeof(buf), "%.2f ns", ns);
+    else if (ns < 1e6) std::snprintf(buf, sizeof(buf), "%.2f us", ns / 1e3);
+    else if (ns < 1e9) std::snprintf(buf, sizeof(buf), "%.2f ms", ns / 1e6);
+    else std::snprintf(buf, sizeof(buf), "%.2f s", ns / 1e9);
+    return buf;
+}
+
+std::string formatRate(double perSec) {
+    char buf[32];
+    if (perSec >= 1e9) std::snprintf(buf, sizeof(buf), "%.2fG/s", perSec / 1e9);
+    else if (perSec >= 1e6) std::snprintf(buf, sizeof(buf), "%.2fM/s", perSec / 1e6);
+    else if (perSec >= 1e3) std::snprintf(buf, sizeof(buf), "%.2fk/s", perSec / 1e3);
+    else std::snprintf(buf, sizeof(buf), "%.2f/s", perSec);
+    return buf;
+}
+
+std::map<std::string, double> loadBaseline(const std::string& path) {
+    std::map<std::string, double> base;
+    std::ifstream in(path);
+    std::string name;
+    double ns;
+    while (in >> name >> ns) {
+        base[name] = ns;
+    }
+    return base;
+}
+
+} // namespace
+
+void State::pauseTiming() {
+    pauseStart = nowNs();
+}
+
+void State::resumeTiming() {
+    pausedNs += nowNs() - pauseStart;
+}
+
+void State::setCounter(const std::string& name, double value) {
+    for (auto& c : counters) {
+        if (c.first == name) {
+            c.second = value;
+            return;
+        }
+    }
+    counters.push_back({name, value});
+}
+
+Registrar::Registrar(const char* name, BenchFn fn, std::vector<int64_t> args) {
+    if (args.empty()) {
+        cases().push_back({name, fn, 0});
+    }
+    for (int64_t a : args) {
+        cases().push_back({std::string(name) + "/" + std::to_string(a), fn, a});
+    }
+}
+
+class Runner {
+public:
+    // runs fn for iters iterations, returns elapsed ns minus paused time
+    static uint64_t timeOnce(const Case& c, uint64_t iters, State* out = nullptr) {
+        State state(iters, c.arg);
+        uint64_t begin = nowNs();
+        c.fn(state);
+        uint64_t elapsed = nowNs() - begin - state.pausedNs;
+        if (out) *out = state;
+        return elapsed;
+    }
+
+    static Result run(const Case& c, const Options& opt) {
+        // warm-up doubles as calibration: grow iters until one run is long enough
+        uint64_t iters = 1;
+        uint64_t warmupEnd = nowNs() + (uint64_t)(opt.warmup * 1e9);
+        uint64_t minNs = (uint64_t)(opt.minTime * 1e9);
+        for (;;) {
+            uint64_t t = timeOnce(c, iters);
+            if (t >= minNs) break;
+            if (nowNs() >= warmupEnd && t * 2 >= minNs) {
+                // close enough, scale up to the target and stop
+                iters = (uint64_t)(iters * ((double)minNs / std::max<uint64_t>(t, 1))) + 1;
+                break;
+            }
+            iters = t == 0 ? iters * 10 : std::max(iters * 2, (uint64_t)(iters * 1.2 * minNs / t));
+        }
+
+        std::vector<double> perIter;
+        State last(iters, c.arg);
+#ifdef PRACTICE_TRACK_ALLOC
+        alloc::resetPeak();
+        alloc::Totals before = alloc::totals();
+#endif
+        for (int r = 0; r < opt.reps; r++) {
+            perIter.push_back((double)timeOnce(c, iters, &last) / iters);
+        }
+#ifdef PRACTICE_TRACK_ALLOC
+        alloc::Totals after = alloc::totals();
+        double runs = (double)iters * opt.reps;
+        last.setCounter("allocs/iter", (after.allocs - before.allocs) / runs);
+        last.setCounter("bytes/iter", (after.bytesAllocated - before.bytesAllocated) / runs);
+        last.setCounter("peak_bytes", (double)(after.peakBytes - before.liveBytes)); // above what was live at the start
+#endif
+        std::sort(perIter.begin(), perIter.end());
+
+        Result res;
+        res.name = c.name;
+        res.iterations = iters;
+        size_t n = perIter.size();
+        res.medianNs = n % 2 ? perIter[n / 2] : (perIter[n / 2 - 1] + perIter[n / 2]) / 2;
+        double sum = 0;
+        for (double v : perIter) sum += v;
+        res.meanNs = sum / n;
+        double var = 0;
+        for (double v : perIter) var += (v - res.meanNs) * (v - res.meanNs);
+        res.stddevNs = n > 1 ? std::sqrt(var / (n - 1)) : 0;
+        res.minNs = perIter.front();
+        res.items = last.items;
+        res.counters = last.counters;
+        return res;
+    }
+};
+
+int runMain(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (opt.list) {
+        for (auto& c : cases()) std::cout << c.name << "\n";
+        return 0;
+    }
+
+    if (opt.cpu >= 0 && !pinToCpu(opt.cpu)) {
+        std::cerr << "could not pin to CPU " << opt.cpu << ": " << std::strerror(errno) << "\n";
+        return 2;
+    }
+
+    std::map<std::string, double> baseline;
+    if (!opt.compare.empty()) {
+        baseline = loadBaseline(opt.compare);
+        if (baseline.empty()) {
+            std::cerr << "no baseline entries in " << opt.compare << "\n";
+            return 2;
+        }
+    }
+
+    std::printf("%-40s %10s %12s %12s %10s %12s %10s\n",
+                "case", "iters", "median", "mean", "cv%", "min", "items");
+    std::vector<Result> results;
+    int regressions = 0;
+    for (auto& c : cases()) {
+        if (!opt.filter.empty() && c.name.find(opt.filter) == std::string::npos) continue;
+        if (opt.maxArg > 0 && c.arg > opt.maxArg) continue;
+
+        Result r = Runner::run(c, opt);
+        results.push_back(r);
+        double cv = r.meanNs > 0 ? 100.0 * r.stddevNs / r.meanNs : 0;
+        std::string items = r.items > 0 ? formatRate(r.items * 1e9 / r.medianNs) : "-";
+        std::printf("%-40s %10llu %12s %12s %9.1f%% %12s %10s",
+                    r.name.c_str(), (unsigned long long)r.iterations,
+                    formatNs(r.medianNs).c_str(), formatNs(r.meanNs).c_str(), cv,
+                    formatNs(r.minNs).c_str(), items.c_str());
+        for (auto& ctr : r.counters) {
+            std::printf("  %s=%g", ctr.first.c_str(), ctr.second);
+        }
+        auto it = baseline.find(r.name);
+        if (it != baseline.end()) {
+            double delta = 100.0 * (r.medianNs - it->second) / it->second;
+            bool regressed = delta > opt.threshold;
+            regressions += regressed;
+            std::printf("  [%+.1f%% vs baseline%s]", delta, regressed ? ", REGRESSION" : "");
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+
+    if (!opt.saveBaseline.empty()) {
+        std::ofstream out(opt.saveBaseline);
+        for (auto& r : results) {
+            out << r.name << " " << r.medianNs << "\n";
+        }
+        if (!out) {
+            std::cerr << "could not write " << opt.saveBaseline << "\n";
+            return 2;
+        }
+    }
+
+#ifndef PRACTICE_INSTRUMENT
+    if (!opt.instrJson.empty() || !opt.trace.empty()) {
+        std::cerr << "built without PRACTICE_INSTRUMENT: nothing was recorded\n";
+    }
+#endif
+    if (!opt.instrJson.empty() && !INSTR_DUMP_JSON(opt.instrJson.c_str())) {
+        std::cerr << "could not write " << opt.instrJson << "\n";
+        return 2;
+    }
+    if (!opt.trace.empty() && !INSTR_DUMP_TRACE(opt.trace.c_str())) {
+        std::cerr << "could not write " << opt.trace << "\n";
+        return 2;
+    }
+
+    if (regressions > 0) {
+        std::printf("%d case(s) regressed by more than %.1f%%\n", regressions, opt.threshold);
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace bench
+
+int main(int argc, char** argv) {
+    return bench::runMain(argc, argv);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+// Small in-tree benchmark harness.
+//
+//    BENCH(vector_push_back) {
+//        for (uint64_t i = 0; i < state.iterations(); i++) { ... }
+//    }
+//    BENCH_ARGS(fft_forward, {1024, 65536}) { int n = state.arg(); ... }
+//
+// Each case is warmed up, calibrated so one repetition runs for at least
+// --min-time seconds, then repeated --reps times; the report shows the
+// median/mean/stddev/min of the per-iteration time. --save-baseline and
+// --compare store and check medians for regression runs. See usage() in
+// harness.cpp for all flags.
+
+#include <cstdint>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+class State {
+    uint64_t iters;
+    int64_t argument;
+    uint64_t pausedNs = 0;
+    uint64_t pauseStart = 0;
+    double items = 0;
+    std::vector<std::pair<std::string, double>> counters;
+
+    friend class Runner;
+
+public:
+    State(uint64_t iterations, int64_t arg) : iters(iterations), argument(arg) {}
+
+    uint64_t iterations() const { return iters; }
+    int64_t arg() const { return argument; }
+
+    // exclude setup work (e.g. refilling an array before a sort) from timing
+    void pauseTiming();
+    void resumeTiming();
+
+    // work done per iteration, reported as items/s
+    void setItemsPerIteration(double n) { items = n; }
+
+    // free-form metric reported next to the timings (bytes/point, p99, ...)
+    void setCounter(const std::string& name, double value);
+};
+
+typedef void (*BenchFn)(State&);
+
+struct Registrar {
+    Registrar(const char* name, BenchFn fn, std::vector<int64_t> args = {});
+};
+
+// keeps the compiler from dropping a computed value
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void clobberMemory() {
+    asm volatile("" : : : "memory");
+}
+
+// Points std::cout at a buffer that accepts everything and drops it, for
+// cases timing code that prints. The stream stays good, so every << still
+// formats its output; only the write to the terminal is skipped. (A null
+// rdbuf would set badbit and make << return before formatting.)
+class MuteCout {
+    class Discard : public std::streambuf {
+        char buf[1024];
+    public:
+        Discard() { setp(buf, buf + sizeof(buf)); }
+    protected:
+        int overflow(int c) override {
+            setp(buf, buf + sizeof(buf));
+            return traits_type::not_eof(c);
+        }
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    };
+
+    Discard sink;
+    std::streambuf* saved;
+
+public:
+    MuteCout() : saved(std::cout.rdbuf(&sink)) {}
+    ~MuteCout() { std::cout.rdbuf(saved); }
+    MuteCout(const MuteCout&) = delete;
+    MuteCout& operator=(const MuteCout&) = delete;
+};
+
+// parses flags, runs the registered cases; returns the process exit code
+int runMain(int argc, char** argv);
+
+} // namespace bench
+
+#define BENCH(fn) \
+    static void fn(::bench::State& state); \
+    static ::bench::Registrar fn##_registrar(#fn, fn); \
+    static void fn(::bench::State& state)
+
+#define BENCH_ARGS(fn, ...) \
+    static void fn(::bench::State& state); \
+    static ::bench::Registrar fn##_registrar(#fn, fn, std::vector<int64_t> __VA_ARGS__); \
+    static void fn(::bench::State& state)
@@ -0,0 +1,509 @@
+#include "alloc_tracker.h"
+
+#ifdef PRACTICE_TRACK_ALLOC
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace alloc {
+
+namespace {
+
+const uint32_t kMagicScalar = 0x5ca1ab1e;
+const uint32_t kMagicArray = 0xa11a7a7a;
+const uint32_t kMagicFreed = 0xdeadf4ee;
+
+const int kMaxSubsystems = 64;
+const int kSizeBuckets = 40;
+const int kMaxSites = 4096; // power of two
+const int kSiteProbes = 16;
+const int kMaxThreads = 64;
+const int kQuarantine = 256; // power of two
+const uint64_t kQuarantineMaxSize = 4096;
+
+// sits just before every pointer we hand out; 16 bytes keeps the
+// alignment malloc gives us
+struct Header {
+    uint32_t magic;
+    uint16_t site;
+    uint8_t subsystem;
+    uint8_t alignShift; // 0 = plain malloc, else block starts 1 << alignShift bytes earlier
+    uint64_t size;
+};
+static_assert(sizeof(Header) == 16, "header must keep 16-byte alignment");
+
+struct Counters {
+    std::atomic<uint64_t> allocs{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> liveAllocs{0};
+    std::atomic<uint64_t> liveBytes{0};
+    std::atomic<uint64_t> sizes[kSizeBuckets] = {};
+};
+
+struct SiteCounts {
+    std::atomic<uint64_t> allocs{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> liveAllocs{0};
+    std::atomic<uint64_t> liveBytes{0};
+};
+
+// One per thread, so the per-allocation counters never share a cache line
+// with another thread's and reports add the blocks up. A block is freed
+// by whichever thread deletes it, so one block's live counts can wrap
+// below zero; only the sum over all blocks means anything.
+struct alignas(64) ThreadStats {
+    Counters subsystems[kMaxSubsystems];
+    SiteCounts sites[kMaxSites];
+    // recently freed small blocks, held back from free() so a second
+    // delete still finds kMagicFreed in their header
+    Header* quarantine[kQuarantine] = {};
+    uint32_t quarantineNext = 0;
+};
+
+// where a call site was first seen; written once per site
+struct Site {
+    std::atomic<uintptr_t> pc{0};
+    std::atomic<uint8_t> subsystem{0};
+    std::atomic<uint64_t> mismatches{0}; // rare, so shared
+};
+
+// All state is zero-initialised static storage: operator new can run
+// before any constructor in this file, and none of it may allocate.
+std::atomic<const char*> subsystemNames[kMaxSubsystems];
+std::atomic<int> subsystemCount{1};
+std::atomic<uint64_t> subsystemMismatches[kMaxSubsystems];
+ThreadStats threadStats[kMaxThreads + 1]; // the last is shared by threads past kMaxThreads
+std::atomic<int> threadCount{0};
+Site sites[kMaxSites]; // sites[0] collects overflow
+// exact peak tracking needs one process-wide live count
+std::atomic<uint64_t> liveBytes{0};
+std::atomic<uint64_t> peakBytes{0};
+std::atomic<uint64_t> badFrees{0};
+
+thread_local int currentSubsystem = 0;
+thread_local ThreadStats* myStats = nullptr;
+
+ThreadStats& stats() {
+    if (!myStats) {
+        int i = threadCount.fetch_add(1, std::memory_order_relaxed);
+        myStats = &threadStats[i < kMaxThreads ? i : kMaxThreads];
+    }
+    return *myStats;
+}
+
+// number of threadStats entries in use
+int statsInUse() {
+    return std::min(threadCount.load(std::memory_order_relaxed), kMaxThreads + 1);
+}
+
+// The owning thread is the only writer of its block, so it can skip the
+// locked add; threads sharing the overflow block cannot.
+void bump(std::atomic<uint64_t>& counter, uint64_t delta, bool owned) {
+    if (owned) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    } else {
+        counter.fetch_add(delta, std::memory_order_relaxed);
+    }
+}
+
+int sizeBucket(uint64_t size) {
+    int b = 63 - __builtin_clzll(size | 1);
+    return b < kSizeBuckets ? b : kSizeBuckets - 1;
+}
+
+uint16_t siteFor(uintptr_t pc) {
+    uint64_t h = ((uint64_t)pc >> 2) * 0x9e3779b97f4a7c15ull;
+    int start = (int)(h >> 52) & (kMaxSites - 1);
+    for (int i = 0; i < kSiteProbes; i++) {
+        int idx = (start + i) & (kMaxSites - 1);
+        if (idx == 0) continue;
+        uintptr_t seen = sites[idx].pc.load(std::memory_order_relaxed);
+        if (seen == pc) return (uint16_t)idx;
+        if (seen == 0 && sites[idx].pc.compare_exchange_strong(seen, pc, std::memory_order_relaxed)) {
+            sites[idx].subsystem.store((uint8_t)currentSubsystem, std::memory_order_relaxed);
+            return (uint16_t)idx;
+        }
+        if (seen == pc) return (uint16_t)idx; // lost the race to the same pc
+    }
+    return 0;
+}
+
+void noteAlloc(Header* h, size_t size, uintptr_t pc) {
+    h->size = size;
+    h->subsystem = (uint8_t)currentSubsystem;
+    h->site = siteFor(pc);
+
+    ThreadStats& t = stats();
+    bool owned = &t != &threadStats[kMaxThreads];
+    Counters& c = t.subsystems[h->subsystem];
+    bump(c.allocs, 1, owned);
+    bump(c.bytes, size, owned);
+    bump(c.liveAllocs, 1, owned);
+    bump(c.liveBytes, size, owned);
+    bump(c.sizes[sizeBucket(size)], 1, owned);
+
+    SiteCounts& s = t.sites[h->site];
+    bump(s.allocs, 1, owned);
+    bump(s.bytes, size, owned);
+    bump(s.liveAllocs, 1, owned);
+    bump(s.liveBytes, size, owned);
+
+    uint64_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void* allocate(size_t size, size_t align, bool array, uintptr_t pc) {
+    Header* h;
+    uint8_t shift = 0;
+    if (align <= alignof(std::max_align_t)) {
+        void* block = std::malloc(sizeof(Header) + size);
+        if (!block) return nullptr;
+        h = (Header*)block;
+    } else {
+        // header goes in the last 16 bytes of an extra align-sized prefix
+        size_t total = (align + size + align - 1) & ~(align - 1);
+        char* block = (char*)std::aligned_alloc(align, total);
+        if (!block) return nullptr;
+        h = (Header*)(block + align) - 1;
+        shift = (uint8_t)__builtin_ctzll(align);
+    }
+    h->magic = array ? kMagicArray : kMagicScalar;
+    h->alignShift = shift;
+    noteAlloc(h, size, pc);
+    return h + 1;
+}
+
+void* allocateOrThrow(size_t size, size_t align, bool array, uintptr_t pc) {
+    for (;;) {
+        void* p = allocate(size, align, array, pc);
+        if (p) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void freeBlock(Header* h) {
+    if (h->alignShift == 0) {
+        std::free(h);
+    } else {
+        std::free((char*)(h + 1) - ((size_t)1 << h->alignShift));
+    }
+}
+
+void release(void* p, bool array) {
+    if (!p) return;
+    Header* h = (Header*)p - 1;
+    // Only reliable while a double-freed block is still in quarantine;
+    // otherwise this reads memory already given back to malloc.
+    uint32_t magic = h->magic;
+    if (magic != kMagicScalar && magic != kMagicArray) {
+        // double free or a pointer we never returned; freeing it would
+        // corrupt the heap, so count it and leak it instead
+        badFrees.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if ((magic == kMagicArray) != array) {
+        subsystemMismatches[h->subsystem].fetch_add(1, std::memory_order_relaxed);
+        sites[h->site].mismatches.fetch_add(1, std::memory_order_relaxed);
+    }
+    ThreadStats& t = stats();
+    bool owned = &t != &threadStats[kMaxThreads];
+    Counters& c = t.subsystems[h->subsystem];
+    SiteCounts& s = t.sites[h->site];
+    bump(c.frees, 1, owned);
+    bump(c.liveAllocs, -1, owned);
+    bump(c.liveBytes, -h->size, owned);
+    bump(s.liveAllocs, -1, owned);
+    bump(s.liveBytes, -h->size, owned);
+    liveBytes.fetch_sub(h->size, std::memory_order_relaxed);
+
+    h->magic = kMagicFreed;
+    // the shared overflow block has no owner to keep its ring consistent
+    if (h->size <= kQuarantineMaxSize && owned) {
+        Header*& slot = t.quarantine[t.quarantineNext++ & (kQuarantine - 1)];
+        std::swap(slot, h);
+        if (!h) return;
+    }
+    freeBlock(h);
+}
+
+const char* subsystemName(int id) {
+    const char* name = id == 0 ? "other" : subsystemNames[id].load(std::memory_order_acquire);
+    return name ? name : "?";
+}
+
+Totals totalsOf(int subsystem) {
+    Totals t;
+    int n = statsInUse();
+    for (int i = 0; i < n; i++) {
+        const Counters& c = threadStats[i].subsystems[subsystem];
+        t.allocs += c.allocs.load(std::memory_order_relaxed);
+        t.frees += c.frees.load(std::memory_order_relaxed);
+        t.bytesAllocated += c.bytes.load(std::memory_order_relaxed);
+        t.liveAllocs += c.liveAllocs.load(std::memory_order_relaxed);
+        t.liveBytes += c.liveBytes.load(std::memory_order_relaxed);
+    }
+    t.mismatches = subsystemMismatches[subsystem].load(std::memory_order_relaxed);
+    return t;
+}
+
+uint64_t sizeCount(int subsystem, int bucket) {
+    uint64_t count = 0;
+    int n = statsInUse();
+    for (int i = 0; i < n; i++) {
+        count += threadStats[i].subsystems[subsystem].sizes[bucket].load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+struct SiteTotals {
+    uint64_t allocs = 0;
+    uint64_t bytes = 0;
+    uint64_t liveAllocs = 0;
+    uint64_t liveBytes = 0;
+};
+
+SiteTotals siteTotals(int site) {
+    SiteTotals t;
+    int n = statsInUse();
+    for (int i = 0; i < n; i++) {
+        const SiteCounts& s = threadStats[i].sites[site];
+        t.allocs += s.allocs.load(std::memory_order_relaxed);
+        t.bytes += s.bytes.load(std::memory_order_relaxed);
+        t.liveAllocs += s.liveAllocs.load(std::memory_order_relaxed);
+        t.liveBytes += s.liveBytes.load(std::memory_order_relaxed);
+    }
+    return t;
+}
+
+void printSite(FILE* out, int idx, uint64_t count, uint64_t bytes) {
+    uintptr_t pc = sites[idx].pc.load(std::memory_order_relaxed);
+    std::fprintf(out, "    %10llu allocs %14llu bytes  [%s]  ",
+                 (unsigned long long)count, (unsigned long long)bytes,
+                 subsystemName(sites[idx].subsystem.load(std::memory_order_relaxed)));
+    Dl_info info;
+    if (idx == 0) {
+        std::fprintf(out, "(site table full)\n");
+    } else if (dladdr((void*)pc, &info) && info.dli_sname) {
+        // __cxa_demangle mallocs its result, which does not come back here
+        int status = 0;
+        char* pretty = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        std::fprintf(out, "%s+0x%lx\n", status == 0 ? pretty : info.dli_sname,
+                     (unsigned long)(pc - (uintptr_t)info.dli_saddr));
+        std::free(pretty);
+    } else if (info.dli_fname) {
+        std::fprintf(out, "%s+0x%lx\n", info.dli_fname, (unsigned long)(pc - (uintptr_t)info.dli_fbase));
+    } else {
+        std::fprintf(out, "0x%lx\n", (unsigned long)pc);
+    }
+}
+
+// runs after the other static destructors (init_priority 101 is
+// constructed first, so destroyed last)
+struct ExitCheck {
+    ~ExitCheck() {
+        const char* env = std::getenv("PRACTICE_ALLOC_REPORT");
+        if (env && *env && std::strcmp(env, "0") != 0) {
+            report(stderr);
+        }
+        Totals t = totals();
+        if (t.mismatches || t.badFrees) {
+            std::fprintf(stderr, "alloc: %llu mismatched and %llu bad frees\n",
+                         (unsigned long long)t.mismatches, (unsigned long long)t.badFrees);
+        }
+        reportLeaks(stderr);
+    }
+};
+__attribute__((init_priority(101))) ExitCheck exitCheck;
+
+} // namespace
+
+int subsystemId(const char* name) {
+    int n = subsystemCount.load(std::memory_order_acquire);
+    for (int i = 1; i < n; i++) {
+        const char* seen = subsystemNames[i].load(std::memory_order_acquire);
+        if (seen && std::strcmp(seen, name) == 0) return i;
+    }
+    // claim a new slot; a racing duplicate registration only wastes a slot
+    int id = subsystemCount.fetch_add(1, std::memory_order_acq_rel);
+    if (id >= kMaxSubsystems) {
+        subsystemCount.store(kMaxSubsystems, std::memory_order_relaxed);
+        return 0;
+    }
+    subsystemNames[id].store(name, std::memory_order_release);
+    return id;
+}
+
+Scope::Scope(int subsystem) : previous(currentSubsystem) {
+    currentSubsystem = subsystem;
+}
+
+Scope::~Scope() {
+    currentSubsystem = previous;
+}
+
+Totals totals() {
+    Totals t;
+    int n = std::min(subsystemCount.load(std::memory_order_acquire), kMaxSubsystems);
+    for (int i = 0; i < n; i++) {
+        Totals s = totalsOf(i);
+        t.allocs += s.allocs;
+        t.frees += s.frees;
+        t.bytesAllocated += s.bytesAllocated;
+        t.liveAllocs += s.liveAllocs;
+        t.liveBytes += s.liveBytes;
+        t.mismatches += s.mismatches;
+    }
+    t.peakBytes = peakBytes.load(std::memory_order_relaxed);
+    t.badFrees = badFrees.load(std::memory_order_relaxed);
+    return t;
+}
+
+void resetPeak() {
+    peakBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+Totals subsystemTotals(const char* name) {
+    int n = std::min(subsystemCount.load(std::memory_order_acquire), kMaxSubsystems);
+    for (int i = 0; i < n; i++) {
+        if (std::strcmp(subsystemName(i), name) == 0) return totalsOf(i);
+    }
+    return Totals();
+}
+
+void report(FILE* out) {
+    Totals t = totals();
+    std::fprintf(out, "alloc: %llu allocs, %llu frees, %llu bytes allocated, "
+                      "%llu live bytes, %llu peak bytes, %llu mismatches, %llu bad frees\n",
+                 (unsigned long long)t.allocs, (unsigned long long)t.frees,
+                 (unsigned long long)t.bytesAllocated, (unsigned long long)t.liveBytes,
+                 (unsigned long long)t.peakBytes, (unsigned long long)t.mismatches,
+                 (unsigned long long)t.badFrees);
+
+    int n = std::min(subsystemCount.load(std::memory_order_acquire), kMaxSubsystems);
+    for (int i = 0; i < n; i++) {
+        Totals s = totalsOf(i);
+        if (s.allocs == 0) continue;
+        std::fprintf(out, "  %-16s %10llu allocs %14llu bytes %10llu live %14llu live bytes %6llu mismatches\n",
+                     subsystemName(i), (unsigned long long)s.allocs,
+                     (unsigned long long)s.bytesAllocated, (unsigned long long)s.liveAllocs,
+                     (unsigned long long)s.liveBytes, (unsigned long long)s.mismatches);
+        std::fprintf(out, "    sizes (log2 bytes: count):");
+        for (int b = 0; b < kSizeBuckets; b++) {
+            uint64_t count = sizeCount(i, b);
+            if (count) std::fprintf(out, " %d:%llu", b, (unsigned long long)count);
+        }
+        std::fprintf(out, "\n");
+    }
+
+    // top call sites by allocation count, picked without allocating
+    const int kTop = 10;
+    int top[kTop];
+    SiteTotals topTotals[kTop];
+    int found = 0;
+    for (int i = 0; i < kMaxSites; i++) {
+        if (sites[i].pc.load(std::memory_order_relaxed) == 0 && i != 0) continue;
+        SiteTotals st = siteTotals(i);
+        if (st.allocs == 0) continue;
+        int pos = found < kTop ? found++ : kTop;
+        while (pos > 0 && topTotals[pos - 1].allocs < st.allocs) {
+            if (pos < kTop) {
+                top[pos] = top[pos - 1];
+                topTotals[pos] = topTotals[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < kTop) {
+            top[pos] = i;
+            topTotals[pos] = st;
+        }
+    }
+    std::fprintf(out, "  top call sites:\n");
+    for (int k = 0; k < found; k++) {
+        printSite(out, top[k], topTotals[k].allocs, topTotals[k].bytes);
+    }
+    for (int i = 0; i < kMaxSites; i++) {
+        uint64_t m = sites[i].mismatches.load(std::memory_order_relaxed);
+        if (m) {
+            std::fprintf(out, "  mismatched delete for block from:\n");
+            printSite(out, i, m, 0);
+        }
+    }
+}
+
+bool reportLeaks(FILE* out) {
+    bool any = false;
+    for (int i = 0; i < kMaxSites; i++) {
+        if (sites[i].pc.load(std::memory_order_relaxed) == 0 && i != 0) continue;
+        SiteTotals st = siteTotals(i);
+        if (st.liveAllocs == 0) continue;
+        if (!any) std::fprintf(out, "alloc: live allocations (leaks if at exit):\n");
+        any = true;
+        printSite(out, i, st.liveAllocs, st.liveBytes);
+    }
+    return any;
+}
+
+} // namespace alloc
+
+#define ALLOC_CALLER ((uintptr_t)__builtin_return_address(0))
+
+void* operator new(size_t size) {
+    return alloc::allocateOrThrow(size, 0, false, ALLOC_CALLER);
+}
+
+void* operator new[](size_t size) {
+    return alloc::allocateOrThrow(size, 0, true, ALLOC_CALLER);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return alloc::allocate(size, 0, false, ALLOC_CALLER);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return alloc::allocate(size, 0, true, ALLOC_CALLER);
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    return alloc::allocateOrThrow(size, (size_t)align, false, ALLOC_CALLER);
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+    return alloc::allocateOrThrow(size, (size_t)align, true, ALLOC_CALLER);
+}
+
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return alloc::allocate(size, (size_t)align, false, ALLOC_CALLER);
+}
+
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return alloc::allocate(size, (size_t)align, true, ALLOC_CALLER);
+}
+
+void operator delete(void* p) noexcept { alloc::release(p, false); }
+void operator delete[](void* p) noexcept { alloc::release(p, true); }
+void operator delete(void* p, size_t) noexcept { alloc::release(p, false); }
+void operator delete[](void* p, size_t) noexcept { alloc::release(p, true); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { alloc::release(p, false); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { alloc::release(p, true); }
+void operator delete(void* p, std::align_val_t) noexcept { alloc::release(p, false); }
+void operator delete[](void* p, std::align_val_t) noexcept { alloc::release(p, true); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { alloc::release(p, false); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { alloc::release(p, true); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { alloc::release(p, false); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { alloc::release(p, true); }
+
+#endif
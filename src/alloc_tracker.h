@@ -0,0 +1,84 @@
+#pragma once
+
+// Allocation tracking mode. When PRACTICE_TRACK_ALLOC is defined (CMake
+// option of the same name), alloc_tracker.cpp replaces every global
+// operator new/delete and keeps:
+//   - allocation/free counts, bytes, live bytes and peak live bytes
+//   - the same numbers per subsystem, plus a log2 size histogram
+//   - per call-site counts (return address of operator new)
+//   - new/delete[] (and new[]/delete) mismatches, double and foreign frees
+// Leaks and mismatches are printed to stderr at exit. Setting
+// PRACTICE_ALLOC_REPORT=1 in the environment prints the full report too.
+//
+// Attribute work to a subsystem for the rest of a scope with
+//    ALLOC_SCOPE("vector");
+// Allocations made outside any scope are counted under "other".
+//
+// Each block carries a 16-byte header. Counters are kept per thread and
+// added up when reporting, so threads allocating from the same subsystem
+// or call site don't contend; the one shared counter is the process-wide
+// live byte count that exact peak tracking needs.
+//
+// Double frees are caught while the block sits in the freeing thread's
+// quarantine (its last 256 frees of up to 4 KiB). For larger or older
+// blocks the check reads memory malloc already owns, so it is best-effort.
+
+#include <cstdint>
+#include <cstdio>
+
+#include "instrument.h" // INSTR_CAT
+
+#ifdef PRACTICE_TRACK_ALLOC
+
+namespace alloc {
+
+struct Totals {
+    uint64_t allocs = 0;
+    uint64_t frees = 0;
+    uint64_t bytesAllocated = 0;
+    uint64_t liveAllocs = 0;
+    uint64_t liveBytes = 0;
+    uint64_t peakBytes = 0; // process-wide only, 0 in per-subsystem totals
+    uint64_t mismatches = 0; // new/delete[] or new[]/delete
+    uint64_t badFrees = 0; // double frees and pointers we never handed out
+};
+
+// returns the id for name, registering it on first use (max 63 names)
+int subsystemId(const char* name);
+
+// process-wide totals
+Totals totals();
+
+// restarts peak tracking from the current live bytes, so peakBytes after
+// a piece of work is that work's high-water mark
+void resetPeak();
+
+// totals for one subsystem, zeroes if name was never registered
+Totals subsystemTotals(const char* name);
+
+// prints totals, per-subsystem tables and the busiest call sites
+void report(FILE* out);
+
+// prints live allocations grouped by call site; returns true if any
+bool reportLeaks(FILE* out);
+
+class Scope {
+    int previous;
+public:
+    explicit Scope(int subsystem);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+};
+
+} // namespace alloc
+
+#define ALLOC_SCOPE(name) \
+    static const int INSTR_CAT(allocSub_, __LINE__) = ::alloc::subsystemId(name); \
+    ::alloc::Scope INSTR_CAT(allocScope_, __LINE__)(INSTR_CAT(allocSub_, __LINE__))
+
+#else
+
+#define ALLOC_SCOPE(name) do { } while (0)
+
+#endif
@@ -0,0 +1,192 @@
+#include "book_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+#include "alloc_tracker.h"
+#include "instrument.h"
+#include "intersect.h"
+
+namespace {
+
+void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((uint8_t)v);
+}
+
+} // namespace
+
+std::vector<std::string> BookIndex::tokenize(const std::string& text) {
+    std::vector<std::string> tokens;
+    std::string current;
+    for (char ch : text) {
+        unsigned char c = (unsigned char)ch;
+        if (std::isalnum(c)) {
+            current += (char)std::tolower(c);
+        } else if (!current.empty()) {
+            tokens.push_back(current);
+            current.clear();
+        }
+    }
+    if (!current.empty()) tokens.push_back(current);
+    return tokens;
+}
+
+void BookIndex::add(const Book& b) {
+    INSTR_SCOPE("book_index.add");
+    ALLOC_SCOPE("book_index");
+    uint32_t id = (uint32_t)b.getId();
+    if (id <= lastBookId) {
+        throw std::invalid_argument("BookIndex::add: book ids must increase");
+    }
+
+    // one posting per distinct term, with the fields it appeared in
+    std::vector<std::pair<std::string, uint8_t>> seen;
+    auto collect = [&](const std::string& text, uint8_t field) {
+        for (auto& t : tokenize(text)) {
+            auto it = std::find_if(seen.begin(), seen.end(), [&](auto& s) { return s.first == t; });
+            if (it == seen.end()) seen.push_back({t, field});
+            else it->second |= field;
+        }
+    };
+    collect(b.getTitle(), kTitleField);
+    collect(b.getAuthor(), kAuthorField);
+
+    for (auto& s : seen) {
+        PostingList& list = terms[s.first];
+        if (list.count % kBlockSize == 0) {
+            list.blockOffset.push_back((uint32_t)list.bytes.size());
+            list.blockLastId.push_back(0);
+        }
+        list.blockLastId.back() = id;
+        // 64-bit: a delta of 2^30 or more does not fit in 32 bits once shifted
+        putVarint(list.bytes, (uint64_t)(id - list.lastId) << 2 | s.second);
+        list.lastId = id;
+        list.count++;
+    }
+    lastBookId = id;
+    bookCount++;
+}
+
+uint32_t BookIndex::decodeBlock(const PostingList& list, size_t b, uint32_t* ids, uint8_t* fields) {
+    uint32_t n = b + 1 < list.blockOffset.size() ? kBlockSize : list.count - (uint32_t)b * kBlockSize;
+    const uint8_t* p = list.bytes.data() + list.blockOffset[b];
+    uint32_t id = b > 0 ? list.blockLastId[b - 1] : 0; // deltas continue across blocks
+    for (uint32_t i = 0; i < n; i++) {
+        uint64_t v = *p & 0x7f;
+        int shift = 7;
+        while (*p++ & 0x80) {
+            v |= (uint64_t)(*p & 0x7f) << shift;
+            shift += 7;
+        }
+        id += (uint32_t)(v >> 2);
+        ids[i] = id;
+        fields[i] = (uint8_t)(v & 3);
+    }
+    return n;
+}
+
+std::vector<SearchHit> BookIndex::search(const std::string& query, size_t k) const {
+    INSTR_SCOPE("book_index.search");
+    std::vector<std::string> words = tokenize(query);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    if (words.empty() || k == 0) return {};
+
+    std::vector<const PostingList*> lists;
+    for (auto& w : words) {
+        auto it = terms.find(w);
+        if (it == terms.end()) return {}; // every term must match
+        lists.push_back(&it->second);
+    }
+    // rarest first keeps the running intersection small
+    std::sort(lists.begin(), lists.end(), [](auto* a, auto* b) { return a->count < b->count; });
+
+    // score: idf per term, doubled when the term is in the title
+    std::vector<double> idf;
+    for (auto* list : lists) {
+        idf.push_back(std::log(1.0 + (double)bookCount / list->count));
+    }
+    auto termScore = [&](size_t t, uint8_t fields) {
+        return idf[t] * ((fields & kTitleField) ? 2.0 : 1.0);
+    };
+
+    uint32_t blockIds[kBlockSize];
+    uint8_t blockFields[kBlockSize];
+    std::vector<uint32_t> matches;
+    std::vector<double> scores;
+    for (size_t b = 0; b < lists[0]->blockOffset.size(); b++) {
+        uint32_t n = decodeBlock(*lists[0], b, blockIds, blockFields);
+        for (uint32_t i = 0; i < n; i++) {
+            matches.push_back(blockIds[i]);
+            scores.push_back(termScore(0, blockFields[i]));
+        }
+    }
+
+    uint32_t common[kBlockSize];
+    std::vector<uint32_t> nextMatches;
+    std::vector<double> nextScores;
+    for (size_t t = 1; t < lists.size() && !matches.empty(); t++) {
+        const PostingList& list = *lists[t];
+        nextMatches.clear();
+        nextScores.clear();
+        size_t pos = 0; // first candidate not yet past
+        for (size_t b = 0; b < list.blockOffset.size() && pos < matches.size(); b++) {
+            if (list.blockLastId[b] < matches[pos]) continue; // skip without decoding
+            size_t endPos = std::upper_bound(matches.begin() + pos, matches.end(), list.blockLastId[b]) - matches.begin();
+            uint32_t n = decodeBlock(list, b, blockIds, blockFields);
+            size_t found = intersectSorted(matches.data() + pos, endPos - pos, blockIds, n, common);
+            // walk the (short) block again to pick up fields and carried scores
+            for (size_t f = 0, i = 0, m = pos; f < found; f++) {
+                while (blockIds[i] != common[f]) i++;
+                while (matches[m] != common[f]) m++;
+                nextMatches.push_back(common[f]);
+                nextScores.push_back(scores[m] + termScore(t, blockFields[i]));
+            }
+            pos = endPos;
+        }
+        matches.swap(nextMatches);
+        scores.swap(nextScores);
+    }
+    if (matches.empty()) return {};
+
+    std::vector<SearchHit> hits(matches.size());
+    for (size_t m = 0; m < matches.size(); m++) {
+        hits[m] = {(int)matches[m], scores[m]};
+    }
+    // best score first, older (lower id) books win ties
+    auto better = [](const SearchHit& a, const SearchHit& b) {
+        return a.score != b.score ? a.score > b.score : a.bookId < b.bookId;
+    };
+    if (hits.size() > k) {
+        std::partial_sort(hits.begin(), hits.begin() + k, hits.end(), better);
+        hits.resize(k);
+    } else {
+        std::sort(hits.begin(), hits.end(), better);
+    }
+    return hits;
+}
+
+size_t BookIndex::getPostingBytes() const {
+    size_t total = 0;
+    for (auto& entry : terms) {
+        const PostingList& list = entry.second;
+        total += list.bytes.capacity() + (list.blockLastId.capacity() + list.blockOffset.capacity()) * sizeof(uint32_t);
+    }
+    return total;
+}
+
+size_t BookIndex::getMemoryBytes() const {
+    // hash node (key, list header, next pointer) plus one bucket pointer
+    size_t total = getPostingBytes() + terms.bucket_count() * sizeof(void*);
+    for (auto& entry : terms) {
+        total += sizeof(entry) + sizeof(void*) + sizeof(size_t);
+        if (entry.first.capacity() > 15) total += entry.first.capacity() + 1; // past the SSO buffer
+    }
+    return total;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "library.h"
+
+struct SearchHit {
+    int bookId;
+    double score;
+};
+
+// Keyword index over Book titles and authors.
+//
+// Each term keeps a posting list of (book id, fields) pairs, stored as
+// varints of (id delta << 2 | field bits), computed in 64 bits so any
+// int id gap fits, and a posting usually takes one or two bytes. Books are appended in id order, which is the order Book
+// hands ids out in, so add() right after constructing a Book keeps the
+// index current without rebuilding anything.
+//
+// Lists are cut into blocks of kBlockSize postings with a skip entry
+// (last id, byte offset) per block, so intersecting a short list with a
+// long one only decodes the long list's blocks that overlap it.
+//
+// search() matches books containing every query term (in the title or
+// author), intersecting the rarest lists first, and returns the k best by
+// a simple idf score where title matches count double.
+class BookIndex {
+    static const uint32_t kBlockSize = 128;
+
+    struct PostingList {
+        std::vector<uint8_t> bytes;
+        std::vector<uint32_t> blockLastId;
+        std::vector<uint32_t> blockOffset;
+        uint32_t count = 0;
+        uint32_t lastId = 0;
+    };
+
+    std::unordered_map<std::string, PostingList> terms;
+    uint32_t lastBookId = 0;
+    size_t bookCount = 0;
+
+    // decodes block b of list into ids and field bits, returns its length
+    static uint32_t decodeBlock(const PostingList& list, size_t b, uint32_t* ids, uint8_t* fields);
+
+public:
+    static const uint8_t kTitleField = 1;
+    static const uint8_t kAuthorField = 2;
+
+    // lower-cased runs of letters and digits
+    static std::vector<std::string> tokenize(const std::string& text);
+
+    // throws std::invalid_argument if b's id is not above every indexed id
+    void add(const Book& b);
+
+    std::vector<SearchHit> search(const std::string& query, size_t k) const;
+
+    size_t getBookCount() const { return bookCount; }
+    size_t getTermCount() const { return terms.size(); }
+    size_t getPostingBytes() const;
+    // postings plus an estimate of the dictionary's own footprint
+    size_t getMemoryBytes() const;
+};
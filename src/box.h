@@ -0,0 +1,11 @@
+#pragma once
+
+// template Box<T> from day 6 that stores a value of any type.
+template <typename T>
+class Box {
+private:
+    T value;
+public:
+    Box(T val) : value(val) {}
+    T getValue() const { return value; }
+};
@@ -0,0 +1,321 @@
+#include "catalog.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "instrument.h"
+#include "io_util.h"
+
+namespace {
+
+const char kAdd = 'A';
+const char kUpdate = 'U';
+const char kRemove = 'R';
+const uint32_t kSnapshotMagic = 0x31534350; // "PCS1"
+
+void putString(std::string& out, const std::string& s) {
+    io::putU32(out, (uint32_t)s.size());
+    out += s;
+}
+
+// reads the put* encodings back, throwing on truncated input
+class Reader {
+    const std::string& data;
+    size_t pos = 0;
+
+    void need(size_t n) {
+        if (pos + n > data.size()) throw std::runtime_error("truncated catalog record");
+    }
+
+public:
+    explicit Reader(const std::string& d, size_t start = 0) : data(d), pos(start) {}
+
+    char getChar() {
+        need(1);
+        return data[pos++];
+    }
+
+    uint32_t getU32() {
+        need(4);
+        uint32_t v;
+        std::memcpy(&v, data.data() + pos, 4);
+        pos += 4;
+        return v;
+    }
+
+    uint64_t getU64() {
+        need(8);
+        uint64_t v;
+        std::memcpy(&v, data.data() + pos, 8);
+        pos += 8;
+        return v;
+    }
+
+    std::string getString() {
+        uint32_t n = getU32();
+        need(n);
+        std::string s = data.substr(pos, n);
+        pos += n;
+        return s;
+    }
+};
+
+std::string encode(char op, const CatalogEntry& e) {
+    std::string out(1, op);
+    io::putU32(out, (uint32_t)e.id);
+    if (op != kRemove) {
+        io::putU32(out, (uint32_t)e.issue);
+        putString(out, e.title);
+        putString(out, e.author);
+    }
+    return out;
+}
+
+void putEntry(std::string& out, const CatalogEntry& e) {
+    io::putU32(out, (uint32_t)e.id);
+    io::putU32(out, (uint32_t)e.issue);
+    putString(out, e.title);
+    putString(out, e.author);
+}
+
+CatalogEntry getEntry(Reader& in) {
+    CatalogEntry e;
+    e.id = (int)in.getU32();
+    e.issue = (int)in.getU32();
+    e.title = in.getString();
+    e.author = in.getString();
+    return e;
+}
+
+void syncDir(const std::string& dir) {
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) throw io::ioError("cannot open directory", dir);
+    int rc = ::fsync(fd);
+    ::close(fd);
+    if (rc != 0) throw io::ioError("cannot sync directory", dir);
+}
+
+} // namespace
+
+std::unique_ptr<LibraryCatalog> LibraryCatalog::open(const std::string& dir, const Library& library, Options opt) {
+    if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw io::ioError("cannot create catalog directory", dir);
+    }
+    std::unique_ptr<LibraryCatalog> c(new LibraryCatalog(dir, library, opt));
+    c->loadSnapshot();
+
+    uint64_t snapshotLsn = c->lastLsn;
+    uint64_t last = WriteAheadLog::replay(dir + "/wal.log", [&](uint64_t lsn, const std::string& record) {
+        if (lsn <= snapshotLsn) return; // already in the snapshot
+        c->apply(record);
+        c->recordsSinceSnapshot++;
+    });
+    if (last > c->lastLsn) c->lastLsn = last;
+    Book::reserveIds(c->highestId);
+    c->log = std::make_unique<WriteAheadLog>(dir + "/wal.log", c->lastLsn + 1, opt.log);
+    return c;
+}
+
+void LibraryCatalog::apply(const std::string& record) {
+    Reader in(record);
+    char op = in.getChar();
+    int id = (int)in.getU32();
+    if (op == kRemove) {
+        entries.erase(id);
+        return;
+    }
+    CatalogEntry e;
+    e.id = id;
+    e.issue = (int)in.getU32();
+    e.title = in.getString();
+    e.author = in.getString();
+    if (op != kAdd && op != kUpdate) throw std::runtime_error("unknown catalog record type");
+    entries[id] = e;
+    if (id > highestId) highestId = id;
+}
+
+void LibraryCatalog::commit(std::unique_lock<std::mutex>& lock, int id, const std::string& record) {
+    INSTR_COUNT("catalog.mutation");
+    forgetDurable();
+    // append and apply under the lock so the log order is the apply order
+    uint64_t lsn = log->append(record);
+    auto it = entries.find(id);
+    undo.push_back({lsn, id, it == entries.end() ? std::nullopt : std::optional<CatalogEntry>(it->second), highestId});
+    apply(record);
+    lastLsn = lsn;
+    recordsSinceSnapshot++;
+    bool compactNow = opt.compactAfterRecords > 0 && recordsSinceSnapshot >= opt.compactAfterRecords;
+    lock.unlock();
+
+    try {
+        log->waitDurable(lsn);
+    } catch (...) {
+        lock.lock();
+        rollBackUndurable();
+        throw;
+    }
+    if (compactNow) {
+        compact();
+    }
+}
+
+void LibraryCatalog::forgetDurable() {
+    if (undo.empty()) return;
+    uint64_t durable = log->getDurableLsn();
+    while (!undo.empty() && undo.front().lsn <= durable) undo.pop_front();
+}
+
+// the log has failed: whatever it did not make durable will not be there
+// after a restart, so take it back out of memory too, newest first
+void LibraryCatalog::rollBackUndurable() {
+    uint64_t durable = log->getDurableLsn();
+    while (!undo.empty() && undo.back().lsn > durable) {
+        const Undo& u = undo.back();
+        if (u.before) {
+            entries[u.id] = *u.before;
+        } else {
+            entries.erase(u.id);
+        }
+        highestId = u.highestIdBefore;
+        if (recordsSinceSnapshot > 0) recordsSinceSnapshot--;
+        undo.pop_back();
+    }
+    if (lastLsn > durable) lastLsn = durable;
+    forgetDurable();
+}
+
+void LibraryCatalog::add(const CatalogEntry& e) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (entries.count(e.id)) {
+        throw std::invalid_argument("book " + std::to_string(e.id) + " is already in the catalog");
+    }
+    commit(lock, e.id, encode(kAdd, e));
+}
+
+void LibraryCatalog::addBook(const Book& b) {
+    add({b.getId(), b.getTitle(), b.getAuthor(), -1});
+}
+
+void LibraryCatalog::addMagazine(const Magazine& m) {
+    add({m.getId(), m.getTitle(), m.getAuthor(), m.getIssueNumber()});
+}
+
+bool LibraryCatalog::updateBook(int id, const std::string& title, const std::string& author) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = entries.find(id);
+    if (it == entries.end()) return false;
+    commit(lock, id, encode(kUpdate, {id, title, author, it->second.issue}));
+    return true;
+}
+
+bool LibraryCatalog::removeBook(int id) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!entries.count(id)) return false;
+    commit(lock, id, encode(kRemove, {id, "", "", -1}));
+    return true;
+}
+
+std::optional<CatalogEntry> LibraryCatalog::find(int id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(id);
+    if (it == entries.end()) return std::nullopt;
+    return it->second;
+}
+
+size_t LibraryCatalog::getSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+void LibraryCatalog::compact() {
+    INSTR_SCOPE("catalog.compact");
+    std::lock_guard<std::mutex> lock(mutex);
+    if (recordsSinceSnapshot == 0) return;
+    // the snapshot may only claim lastLsn once everything up to it is on disk
+    try {
+        log->waitDurable(lastLsn);
+    } catch (...) {
+        rollBackUndurable();
+        throw;
+    }
+    writeSnapshot();
+    log->truncate();
+    undo.clear();
+    recordsSinceSnapshot = 0;
+}
+
+void LibraryCatalog::writeSnapshot() {
+    std::string out;
+    io::putU32(out, kSnapshotMagic);
+    io::putU64(out, lastLsn);
+    io::putU32(out, (uint32_t)highestId);
+    putString(out, library.getName());
+    putString(out, library.getAddress());
+    io::putU32(out, (uint32_t)entries.size());
+    for (auto& entry : entries) {
+        putEntry(out, entry.second);
+    }
+    io::putU32(out, crc32c(out.data(), out.size()));
+
+    // write aside, sync, then rename over the old one so a crash leaves
+    // either the old or the new snapshot, never half of one
+    std::string path = dir + "/catalog.snap";
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) throw io::ioError("cannot create snapshot", tmp);
+    if (!io::writeAll(fd, out.data(), out.size())) {
+        std::runtime_error error = io::ioError("cannot write snapshot", tmp);
+        ::close(fd);
+        throw error;
+    }
+    if ((opt.log.sync && ::fsync(fd) != 0) || ::close(fd) != 0) {
+        throw io::ioError("cannot sync snapshot", tmp);
+    }
+    if (::rename(tmp.c_str(), path.c_str()) != 0) {
+        throw io::ioError("cannot install snapshot", path);
+    }
+    if (opt.log.sync) syncDir(dir);
+}
+
+bool LibraryCatalog::loadSnapshot() {
+    std::string path = dir + "/catalog.snap";
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) return false;
+        throw io::ioError("cannot open snapshot", path);
+    }
+    std::string data;
+    if (!io::readAll(fd, data)) {
+        std::runtime_error error = io::ioError("cannot read snapshot", path);
+        ::close(fd);
+        throw error;
+    }
+    ::close(fd);
+
+    // unlike the log, a bad snapshot is not something to skip past: the
+    // log before it is gone
+    uint32_t crc;
+    if (data.size() < 4 || (std::memcpy(&crc, data.data() + data.size() - 4, 4),
+                            crc32c(data.data(), data.size() - 4) != crc)) {
+        throw std::runtime_error("corrupt catalog snapshot " + path);
+    }
+    Reader in(data);
+    if (in.getU32() != kSnapshotMagic) throw std::runtime_error("not a catalog snapshot: " + path);
+    lastLsn = in.getU64();
+    highestId = (int)in.getU32();
+    std::string name = in.getString();
+    std::string address = in.getString();
+    library = Library(name, address);
+    uint32_t count = in.getU32();
+    entries.clear();
+    for (uint32_t i = 0; i < count; i++) {
+        CatalogEntry e = getEntry(in);
+        entries[e.id] = e;
+    }
+    return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "library.h"
+#include "wal.h"
+
+// A Library's book catalog that survives restarts.
+//
+// Every add/update/remove is appended to a write-ahead log (wal.log in
+// dir) and the call returns once the record is durable; concurrent callers
+// share one fdatasync through the log's group commit. compact() writes
+// the whole catalog to a checksummed snapshot file and empties the log.
+// open() loads the snapshot and replays the log after it.
+//
+// A mutation is visible to find() as soon as it is logged, slightly
+// before it is durable; only the caller waits for durability. If the log
+// fails to make it durable, every mutation not yet on disk is rolled back
+// and the caller gets the error; the log refuses writes from then on.
+class LibraryCatalog {
+public:
+    struct Options {
+        WriteAheadLog::Options log;
+        size_t compactAfterRecords = 0; // compact automatically, 0 = never
+    };
+
+    // loads dir (created if missing); a fresh catalog is named after library
+    static std::unique_ptr<LibraryCatalog> open(const std::string& dir, const Library& library, Options opt);
+
+    const Library& getLibrary() const { return library; }
+
+    void addBook(const Book& b);
+    void addMagazine(const Magazine& m);
+    bool updateBook(int id, const std::string& title, const std::string& author); // false if unknown
+    bool removeBook(int id); // false if unknown
+
+    std::optional<CatalogEntry> find(int id) const;
+    size_t getSize() const;
+
+    // snapshot + empty log; blocks mutations while it runs
+    void compact();
+
+    uint64_t getGroupCount() { return log->getGroupCount(); }
+
+private:
+    std::string dir;
+    Library library;
+    Options opt;
+    mutable std::mutex mutex; // orders log appends with changes to entries
+    std::map<int, CatalogEntry> entries;
+    std::unique_ptr<WriteAheadLog> log;
+    uint64_t lastLsn = 0;
+    int highestId = 0; // ever added, so removed ids are not handed out again
+    size_t recordsSinceSnapshot = 0;
+
+    // how to undo a mutation that is applied but not yet known durable
+    struct Undo {
+        uint64_t lsn;
+        int id;
+        std::optional<CatalogEntry> before;
+        int highestIdBefore;
+    };
+    std::deque<Undo> undo; // oldest first
+
+    LibraryCatalog(const std::string& d, const Library& lib, Options o) : dir(d), library(lib), opt(o) {}
+
+    // appends and applies record (which changes id) under lock, then
+    // releases it and waits until the record is durable
+    void commit(std::unique_lock<std::mutex>& lock, int id, const std::string& record);
+    void forgetDurable(); // drops undo records the log has made durable
+    void rollBackUndurable();
+    void add(const CatalogEntry& e);
+    void apply(const std::string& record);
+    void writeSnapshot();
+    bool loadSnapshot();
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+// Copy-on-write holder for one T. Copies share a heap node through an
+// atomic refcount; the first write through mut() on a shared holder
+// clones the node (detach), so read-mostly copies never touch the heap.
+// A moved-from Cow holds no node and reads as a default-constructed T.
+// Only worth it when T is costly to copy: for an int the node allocation
+// and refcount cost more than the copy they save.
+template <typename T>
+class Cow {
+    struct Node {
+        std::atomic<int> refs;
+        T value;
+        template <typename... Args>
+        explicit Node(Args&&... args) : refs(1), value(std::forward<Args>(args)...) {}
+    };
+    Node* node;
+
+    static const T& empty() {
+        static const T value{};
+        return value;
+    }
+
+    void release() {
+        if (node && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete node;
+        }
+    }
+
+public:
+    // not a copy: Cow(otherCow) must pick the copy constructor below
+    template <typename... Args>
+        requires (sizeof...(Args) != 1 || !(std::is_same_v<std::remove_cvref_t<Args>, Cow> || ...))
+    explicit Cow(Args&&... args) : node(new Node(std::forward<Args>(args)...)) {}
+
+    Cow(const Cow &other) : node(other.node) {
+        if (node) node->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Cow(Cow &&other) noexcept : node(other.node) {
+        other.node = nullptr;
+    }
+
+    Cow& operator=(const Cow &other) {
+        if (node != other.node) {
+            if (other.node) other.node->refs.fetch_add(1, std::memory_order_relaxed);
+            release();
+            node = other.node;
+        }
+        return *this;
+    }
+
+    Cow& operator=(Cow &&other) noexcept {
+        if (this != &other) {
+            release();
+            node = other.node;
+            other.node = nullptr;
+        }
+        return *this;
+    }
+
+    ~Cow() { release(); }
+
+    const T& get() const { return node ? node->value : empty(); }
+
+    // write access, detaches first if the node is shared
+    T& mut() {
+        if (!node) {
+            node = new Node();
+        } else if (node->refs.load(std::memory_order_acquire) != 1) {
+            Node* copy = new Node(node->value);
+            release();
+            node = copy;
+        }
+        return node->value;
+    }
+
+    // escape hatch: a deep copy that never shares with this one
+    Cow make_unique_copy() const { return Cow(get()); }
+
+    bool isShared() const { return node && node->refs.load(std::memory_order_acquire) != 1; }
+    int useCount() const { return node ? node->refs.load(std::memory_order_relaxed) : 0; }
+};
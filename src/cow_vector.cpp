@@ -0,0 +1,113 @@
+#include "cow_vector.h"
+
+#include <new>
+
+#include "alloc_tracker.h"
+#include "instrument.h"
+
+CowVector::Buffer* CowVector::allocate(int capacity) {
+    ALLOC_SCOPE("vector");
+    void* raw = ::operator new(sizeof(Buffer) + sizeof(int) * (size_t)capacity);
+    Buffer* b = new (raw) Buffer(capacity);
+    new (b + 1) int[capacity];
+    return b;
+}
+
+void CowVector::release(Buffer* b) {
+    if (b && b->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        b->~Buffer();
+        ::operator delete(b);
+    }
+}
+
+void CowVector::detach(int newCapacity) {
+    INSTR_COUNT("cow_vector.detach");
+    Buffer* fresh = allocate(newCapacity);
+    for (int i = 0; i < size; i++) {
+        fresh->data()[i] = buf->data()[i];
+    }
+    release(buf);
+    buf = fresh;
+}
+
+CowVector::CowVector() : buf(allocate(1)), size(0) {}
+
+CowVector::CowVector(int n) : buf(allocate(n > 0 ? n : 1)), size(0) {}
+
+CowVector::CowVector(const CowVector &other) : buf(other.buf), size(other.size) {
+    INSTR_COUNT("cow_vector.share");
+    if (buf) buf->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+CowVector::CowVector(CowVector &&other) noexcept : buf(other.buf), size(other.size) {
+    other.buf = nullptr;
+    other.size = 0;
+}
+
+CowVector& CowVector::operator=(const CowVector &other) {
+    if (buf != other.buf) {
+        INSTR_COUNT("cow_vector.share");
+        if (other.buf) other.buf->refs.fetch_add(1, std::memory_order_relaxed);
+        release(buf);
+        buf = other.buf;
+    }
+    size = other.size;
+    return *this;
+}
+
+CowVector& CowVector::operator=(CowVector &&other) noexcept {
+    if (this != &other) {
+        release(buf);
+        buf = other.buf;
+        size = other.size;
+        other.buf = nullptr;
+        other.size = 0;
+    }
+    return *this;
+}
+
+CowVector::~CowVector() {
+    release(buf);
+}
+
+void CowVector::push_back(int value) {
+    INSTR_COUNT("cow_vector.push_back");
+    int capacity = getCapacity();
+    if (size == capacity) {
+        // growing needs a new buffer anyway, so this also detaches
+        detach(capacity > 0 ? capacity * 2 : 1);
+    } else if (isShared()) {
+        // another copy may already use the slots past our size
+        detach(capacity);
+    }
+    buf->data()[size++] = value;
+}
+
+void CowVector::pop_back() {
+    if (size > 0) {
+        size--;
+    }
+}
+
+void CowVector::set(int i, int value) {
+    if (isShared()) {
+        detach(buf->capacity);
+    }
+    buf->data()[i] = value;
+}
+
+CowVector CowVector::make_unique_copy() const {
+    CowVector copy(size);
+    for (int i = 0; i < size; i++) {
+        copy.buf->data()[i] = buf->data()[i];
+    }
+    copy.size = size;
+    return copy;
+}
+
+void CowVector::print(std::ostream &out) const {
+    for (int i = 0; i < size; i++) {
+        out << buf->data()[i] << " ";
+    }
+    out << std::endl;
+}
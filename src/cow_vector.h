@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <iostream>
+#include <new>
+
+// Copy-on-write version of Vector. Copies share one refcounted buffer;
+// the first write (push_back, set) on a shared copy detaches it into a
+// private buffer. pop_back only shrinks this copy's size, so it never
+// detaches. Use Vector when copies are usually written to.
+class CowVector {
+    // capacity ints follow the header in the same allocation, as an
+    // int array placement-new'd at this + 1
+    struct Buffer {
+        std::atomic<int> refs;
+        int capacity;
+        explicit Buffer(int capacity) : refs(1), capacity(capacity) {}
+        int* data() { return std::launder(reinterpret_cast<int*>(this + 1)); }
+    };
+    static_assert(sizeof(Buffer) % alignof(int) == 0, "elements must be aligned after the header");
+
+    Buffer* buf;
+    int size;
+
+    static Buffer* allocate(int capacity);
+    static void release(Buffer* b);
+    void detach(int newCapacity); // private buffer with room for newCapacity
+
+public:
+    CowVector(); // default constructor
+    explicit CowVector(int n); // reserves room for n elements
+    CowVector(const CowVector &other); // shares other's buffer
+    CowVector(CowVector &&other) noexcept;
+    CowVector& operator=(const CowVector &other);
+    CowVector& operator=(CowVector &&other) noexcept;
+    ~CowVector();
+
+    void push_back(int value);
+    void pop_back();
+
+    int get(int i) const { return buf->data()[i]; }
+    void set(int i, int value);
+    int getSize() const { return size; }
+    int getCapacity() const { return buf ? buf->capacity : 0; }
+
+    // escape hatch: a deep copy that owns its buffer from the start
+    CowVector make_unique_copy() const;
+
+    bool isShared() const { return buf && buf->refs.load(std::memory_order_acquire) != 1; }
+
+    void print(std::ostream &out = std::cout) const;
+};
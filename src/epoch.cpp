@@ -0,0 +1,96 @@
+#include "epoch.h"
+
+#include <atomic>
+#include <stdexcept>
+
+namespace epoch {
+
+namespace {
+
+const uint64_t kIdle = UINT64_MAX;
+
+struct alignas(64) Slot {
+    std::atomic<uint64_t> announced{kIdle};
+    std::atomic<bool> claimed{false};
+};
+
+std::atomic<uint64_t> globalEpoch{1};
+Slot slots[kMaxReaderThreads];
+std::atomic<int> slotsInUse{0}; // high-water mark, bounds the scan in oldestActiveEpoch
+
+// claims a slot on first use and gives it back at thread exit
+struct ThreadSlot {
+    Slot* slot = nullptr;
+    int depth = 0;
+
+    Slot& get() {
+        if (!slot) {
+            for (int i = 0; i < kMaxReaderThreads; i++) {
+                bool expected = false;
+                if (!slots[i].claimed.load(std::memory_order_relaxed) &&
+                    slots[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                    slot = &slots[i];
+                    int used = slotsInUse.load(std::memory_order_relaxed);
+                    while (used < i + 1 && !slotsInUse.compare_exchange_weak(used, i + 1)) {
+                    }
+                    break;
+                }
+            }
+            if (!slot) throw std::runtime_error("epoch: too many reader threads");
+        }
+        return *slot;
+    }
+
+    ~ThreadSlot() {
+        if (slot) {
+            slot->announced.store(kIdle, std::memory_order_release);
+            slot->claimed.store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadSlot mine;
+
+} // namespace
+
+void readLock() {
+    if (mine.depth > 0) {
+        mine.depth++;
+        return;
+    }
+    // claim the slot before counting this lock: if get() throws, the
+    // thread must stay at depth 0 so its next readLock() announces
+    Slot& s = mine.get();
+    mine.depth = 1;
+    // seq_cst store then seq_cst loads by the caller: a writer that
+    // advanced the epoch after this store must see it in canFree()
+    s.announced.store(globalEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+}
+
+void readUnlock() {
+    if (--mine.depth > 0) return;
+    mine.slot->announced.store(kIdle, std::memory_order_release);
+}
+
+uint64_t retireEpoch() {
+    return globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+}
+
+uint64_t oldestActiveEpoch() {
+    uint64_t oldest = kIdle;
+    int n = slotsInUse.load(std::memory_order_acquire);
+    for (int i = 0; i < n; i++) {
+        uint64_t e = slots[i].announced.load(std::memory_order_seq_cst);
+        if (e < oldest) oldest = e;
+    }
+    return oldest;
+}
+
+bool canFree(uint64_t tag) {
+    // a reader that announced tag or earlier may have loaded the old
+    // pointer; one that announced later read the epoch after the advance,
+    // which came after the new version was published
+    return oldestActiveEpoch() > tag;
+}
+
+} // namespace epoch
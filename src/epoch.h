@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+// Epoch-based reclamation for read-copy-update structures.
+//
+// Readers bracket each access with readLock()/readUnlock(): two stores
+// and a load on a per-thread slot, no loops, so reads are wait-free.
+// A writer publishes a new version, calls retireEpoch() and keeps the old
+// version (tagged with the returned epoch) until canFree(tag) says every
+// reader that might still see it has left.
+//
+// Reader slots are claimed on a thread's first readLock() and returned
+// when the thread exits; more than kMaxReaderThreads concurrently live
+// reader threads throws std::runtime_error.
+namespace epoch {
+
+const int kMaxReaderThreads = 256;
+
+void readLock(); // nests; only the outermost call announces
+void readUnlock();
+
+// advances the global epoch; call after publishing, tag retired data with
+// the returned (pre-advance) value
+uint64_t retireEpoch();
+
+// true once no reader can still hold data retired at tag
+bool canFree(uint64_t tag);
+
+// oldest epoch any active reader announced, UINT64_MAX if none
+uint64_t oldestActiveEpoch();
+
+class ReadGuard {
+public:
+    ReadGuard() { readLock(); }
+    ~ReadGuard() { readUnlock(); }
+    ReadGuard(const ReadGuard&) = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+};
+
+} // namespace epoch
@@ -0,0 +1,643 @@
+#include "fft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numbers>
+#include <stdexcept>
+#include <utility>
+
+#include "instrument.h"
+#include "parallel.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// one Stockham stage: sub-transform q of length `length` reads element
+// p + k*m from x and writes element r*p + j to y, with m = length/r
+struct Pass {
+    const float* xr;
+    const float* xi;
+    float* yr;
+    float* yi;
+    const float* wr; // twiddles exp(-2 pi i p j / length), row j-1, column p
+    const float* wi;
+    const float* rr; // roots exp(-2 pi i k / r), generic radix only
+    const float* ri;
+    size_t m;
+    size_t s;
+};
+
+// The kernels loop over q innermost and take four sub-transforms per SSE
+// register, all sharing one twiddle. The first stage has a single
+// sub-transform (s == 1), so radix 2 and 4 vectorize over p there and
+// shuffle the interleaved outputs back into place.
+
+#ifdef __SSE2__
+// (ar + i ai) * (br + i bi), four lanes at a time
+inline void cmul(__m128 ar, __m128 ai, __m128 br, __m128 bi, __m128& outR, __m128& outI) {
+    outR = _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi));
+    outI = _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br));
+}
+#endif
+
+void radix2(const Pass& a, size_t p0, size_t p1, size_t q0, size_t q1) {
+    const size_t m = a.m, s = a.s;
+    const float* __restrict xr = a.xr;
+    const float* __restrict xi = a.xi;
+    float* __restrict yr = a.yr;
+    float* __restrict yi = a.yi;
+    const float* __restrict wr = a.wr;
+    const float* __restrict wi = a.wi;
+    if (s == 1) {
+        size_t p = p0;
+#ifdef __SSE2__
+        // four p at once; outputs 2p and 2p+1 are interleaved on the way out
+        for (; p + 4 <= p1; p += 4) {
+            __m128 ar = _mm_loadu_ps(xr + p), ai = _mm_loadu_ps(xi + p);
+            __m128 br = _mm_loadu_ps(xr + p + m), bi = _mm_loadu_ps(xi + p + m);
+            __m128 sr = _mm_add_ps(ar, br), si = _mm_add_ps(ai, bi);
+            __m128 tr, ti;
+            cmul(_mm_sub_ps(ar, br), _mm_sub_ps(ai, bi), _mm_loadu_ps(wr + p), _mm_loadu_ps(wi + p), tr, ti);
+            _mm_storeu_ps(yr + 2 * p, _mm_unpacklo_ps(sr, tr));
+            _mm_storeu_ps(yr + 2 * p + 4, _mm_unpackhi_ps(sr, tr));
+            _mm_storeu_ps(yi + 2 * p, _mm_unpacklo_ps(si, ti));
+            _mm_storeu_ps(yi + 2 * p + 4, _mm_unpackhi_ps(si, ti));
+        }
+#endif
+        for (; p < p1; p++) {
+            float ar = xr[p], ai = xi[p], br = xr[p + m], bi = xi[p + m];
+            float dr = ar - br, di = ai - bi;
+            yr[2 * p] = ar + br;
+            yi[2 * p] = ai + bi;
+            yr[2 * p + 1] = dr * wr[p] - di * wi[p];
+            yi[2 * p + 1] = dr * wi[p] + di * wr[p];
+        }
+        return;
+    }
+    for (size_t p = p0; p < p1; p++) {
+        const float cr = wr[p], ci = wi[p];
+        const float* __restrict ar = xr + s * p;
+        const float* __restrict ai = xi + s * p;
+        const float* __restrict br = xr + s * (p + m);
+        const float* __restrict bi = xi + s * (p + m);
+        float* __restrict y0r = yr + s * (2 * p);
+        float* __restrict y0i = yi + s * (2 * p);
+        float* __restrict y1r = yr + s * (2 * p + 1);
+        float* __restrict y1i = yi + s * (2 * p + 1);
+        size_t q = q0;
+#ifdef __SSE2__
+        const __m128 vcr = _mm_set1_ps(cr), vci = _mm_set1_ps(ci);
+        for (; q + 4 <= q1; q += 4) {
+            __m128 xar = _mm_loadu_ps(ar + q), xai = _mm_loadu_ps(ai + q);
+            __m128 xbr = _mm_loadu_ps(br + q), xbi = _mm_loadu_ps(bi + q);
+            _mm_storeu_ps(y0r + q, _mm_add_ps(xar, xbr));
+            _mm_storeu_ps(y0i + q, _mm_add_ps(xai, xbi));
+            __m128 tr, ti;
+            cmul(_mm_sub_ps(xar, xbr), _mm_sub_ps(xai, xbi), vcr, vci, tr, ti);
+            _mm_storeu_ps(y1r + q, tr);
+            _mm_storeu_ps(y1i + q, ti);
+        }
+#endif
+        for (; q < q1; q++) {
+            float dr = ar[q] - br[q], di = ai[q] - bi[q];
+            y0r[q] = ar[q] + br[q];
+            y0i[q] = ai[q] + bi[q];
+            y1r[q] = dr * cr - di * ci;
+            y1i[q] = dr * ci + di * cr;
+        }
+    }
+}
+
+// forward radix-4 butterfly: with a..d the four inputs,
+//   y0 = (a+c) + (b+d)       y2 = w^2 ((a+c) - (b+d))
+//   y1 = w ((a-c) - i(b-d))  y3 = w^3 ((a-c) + i(b-d))
+// -i(b-d) is (bi-di, -(br-dr)), so no multiply is needed for it
+void radix4(const Pass& a, size_t p0, size_t p1, size_t q0, size_t q1) {
+    const size_t m = a.m, s = a.s;
+    const float* __restrict xr = a.xr;
+    const float* __restrict xi = a.xi;
+    float* __restrict yr = a.yr;
+    float* __restrict yi = a.yi;
+    const float* __restrict w1r = a.wr;
+    const float* __restrict w1i = a.wi;
+    const float* __restrict w2r = a.wr + m;
+    const float* __restrict w2i = a.wi + m;
+    const float* __restrict w3r = a.wr + 2 * m;
+    const float* __restrict w3i = a.wi + 2 * m;
+    if (s == 1) {
+        size_t p = p0;
+#ifdef __SSE2__
+        // four p at once, then a 4x4 transpose puts outputs 4p..4p+3 side by side
+        for (; p + 4 <= p1; p += 4) {
+            __m128 ar = _mm_loadu_ps(xr + p), ai = _mm_loadu_ps(xi + p);
+            __m128 br = _mm_loadu_ps(xr + p + m), bi = _mm_loadu_ps(xi + p + m);
+            __m128 cr = _mm_loadu_ps(xr + p + 2 * m), ci = _mm_loadu_ps(xi + p + 2 * m);
+            __m128 dr = _mm_loadu_ps(xr + p + 3 * m), di = _mm_loadu_ps(xi + p + 3 * m);
+            __m128 sacr = _mm_add_ps(ar, cr), saci = _mm_add_ps(ai, ci);
+            __m128 dacr = _mm_sub_ps(ar, cr), daci = _mm_sub_ps(ai, ci);
+            __m128 sbdr = _mm_add_ps(br, dr), sbdi = _mm_add_ps(bi, di);
+            __m128 dbdr = _mm_sub_ps(br, dr), dbdi = _mm_sub_ps(bi, di);
+            __m128 y0r = _mm_add_ps(sacr, sbdr), y0i = _mm_add_ps(saci, sbdi);
+            __m128 y1r, y1i, y2r, y2i, y3r, y3i;
+            cmul(_mm_add_ps(dacr, dbdi), _mm_sub_ps(daci, dbdr), _mm_loadu_ps(w1r + p), _mm_loadu_ps(w1i + p), y1r, y1i);
+            cmul(_mm_sub_ps(sacr, sbdr), _mm_sub_ps(saci, sbdi), _mm_loadu_ps(w2r + p), _mm_loadu_ps(w2i + p), y2r, y2i);
+            cmul(_mm_sub_ps(dacr, dbdi), _mm_add_ps(daci, dbdr), _mm_loadu_ps(w3r + p), _mm_loadu_ps(w3i + p), y3r, y3i);
+            _MM_TRANSPOSE4_PS(y0r, y1r, y2r, y3r);
+            _MM_TRANSPOSE4_PS(y0i, y1i, y2i, y3i);
+            _mm_storeu_ps(yr + 4 * p, y0r);
+            _mm_storeu_ps(yr + 4 * p + 4, y1r);
+            _mm_storeu_ps(yr + 4 * p + 8, y2r);
+            _mm_storeu_ps(yr + 4 * p + 12, y3r);
+            _mm_storeu_ps(yi + 4 * p, y0i);
+            _mm_storeu_ps(yi + 4 * p + 4, y1i);
+            _mm_storeu_ps(yi + 4 * p + 8, y2i);
+            _mm_storeu_ps(yi + 4 * p + 12, y3i);
+        }
+#endif
+        for (; p < p1; p++) {
+            float ar = xr[p], ai = xi[p];
+            float br = xr[p + m], bi = xi[p + m];
+            float cr = xr[p + 2 * m], ci = xi[p + 2 * m];
+            float dr = xr[p + 3 * m], di = xi[p + 3 * m];
+            float sacr = ar + cr, saci = ai + ci, dacr = ar - cr, daci = ai - ci;
+            float sbdr = br + dr, sbdi = bi + di, dbdr = br - dr, dbdi = bi - di;
+            float t1r = dacr + dbdi, t1i = daci - dbdr;
+            float t2r = sacr - sbdr, t2i = saci - sbdi;
+            float t3r = dacr - dbdi, t3i = daci + dbdr;
+            yr[4 * p] = sacr + sbdr;
+            yi[4 * p] = saci + sbdi;
+            yr[4 * p + 1] = t1r * w1r[p] - t1i * w1i[p];
+            yi[4 * p + 1] = t1r * w1i[p] + t1i * w1r[p];
+            yr[4 * p + 2] = t2r * w2r[p] - t2i * w2i[p];
+            yi[4 * p + 2] = t2r * w2i[p] + t2i * w2r[p];
+            yr[4 * p + 3] = t3r * w3r[p] - t3i * w3i[p];
+            yi[4 * p + 3] = t3r * w3i[p] + t3i * w3r[p];
+        }
+        return;
+    }
+    for (size_t p = p0; p < p1; p++) {
+        const float c1r = w1r[p], c1i = w1i[p], c2r = w2r[p], c2i = w2i[p], c3r = w3r[p], c3i = w3i[p];
+        const float* __restrict ar = xr + s * p;
+        const float* __restrict ai = xi + s * p;
+        const float* __restrict br = xr + s * (p + m);
+        const float* __restrict bi = xi + s * (p + m);
+        const float* __restrict cr = xr + s * (p + 2 * m);
+        const float* __restrict ci = xi + s * (p + 2 * m);
+        const float* __restrict dr = xr + s * (p + 3 * m);
+        const float* __restrict di = xi + s * (p + 3 * m);
+        float* __restrict y0r = yr + s * (4 * p);
+        float* __restrict y0i = yi + s * (4 * p);
+        float* __restrict y1r = yr + s * (4 * p + 1);
+        float* __restrict y1i = yi + s * (4 * p + 1);
+        float* __restrict y2r = yr + s * (4 * p + 2);
+        float* __restrict y2i = yi + s * (4 * p + 2);
+        float* __restrict y3r = yr + s * (4 * p + 3);
+        float* __restrict y3i = yi + s * (4 * p + 3);
+        size_t q = q0;
+#ifdef __SSE2__
+        const __m128 v1r = _mm_set1_ps(c1r), v1i = _mm_set1_ps(c1i);
+        const __m128 v2r = _mm_set1_ps(c2r), v2i = _mm_set1_ps(c2i);
+        const __m128 v3r = _mm_set1_ps(c3r), v3i = _mm_set1_ps(c3i);
+        for (; q + 4 <= q1; q += 4) {
+            __m128 xar = _mm_loadu_ps(ar + q), xai = _mm_loadu_ps(ai + q);
+            __m128 xbr = _mm_loadu_ps(br + q), xbi = _mm_loadu_ps(bi + q);
+            __m128 xcr = _mm_loadu_ps(cr + q), xci = _mm_loadu_ps(ci + q);
+            __m128 xdr = _mm_loadu_ps(dr + q), xdi = _mm_loadu_ps(di + q);
+            __m128 sacr = _mm_add_ps(xar, xcr), saci = _mm_add_ps(xai, xci);
+            __m128 dacr = _mm_sub_ps(xar, xcr), daci = _mm_sub_ps(xai, xci);
+            __m128 sbdr = _mm_add_ps(xbr, xdr), sbdi = _mm_add_ps(xbi, xdi);
+            __m128 dbdr = _mm_sub_ps(xbr, xdr), dbdi = _mm_sub_ps(xbi, xdi);
+            _mm_storeu_ps(y0r + q, _mm_add_ps(sacr, sbdr));
+            _mm_storeu_ps(y0i + q, _mm_add_ps(saci, sbdi));
+            __m128 tr, ti;
+            cmul(_mm_add_ps(dacr, dbdi), _mm_sub_ps(daci, dbdr), v1r, v1i, tr, ti);
+            _mm_storeu_ps(y1r + q, tr);
+            _mm_storeu_ps(y1i + q, ti);
+            cmul(_mm_sub_ps(sacr, sbdr), _mm_sub_ps(saci, sbdi), v2r, v2i, tr, ti);
+            _mm_storeu_ps(y2r + q, tr);
+            _mm_storeu_ps(y2i + q, ti);
+            cmul(_mm_sub_ps(dacr, dbdi), _mm_add_ps(daci, dbdr), v3r, v3i, tr, ti);
+            _mm_storeu_ps(y3r + q, tr);
+            _mm_storeu_ps(y3i + q, ti);
+        }
+#endif
+        for (; q < q1; q++) {
+            float sacr = ar[q] + cr[q], saci = ai[q] + ci[q], dacr = ar[q] - cr[q], daci = ai[q] - ci[q];
+            float sbdr = br[q] + dr[q], sbdi = bi[q] + di[q], dbdr = br[q] - dr[q], dbdi = bi[q] - di[q];
+            float t1r = dacr + dbdi, t1i = daci - dbdr;
+            float t2r = sacr - sbdr, t2i = saci - sbdi;
+            float t3r = dacr - dbdi, t3i = daci + dbdr;
+            y0r[q] = sacr + sbdr;
+            y0i[q] = saci + sbdi;
+            y1r[q] = t1r * c1r - t1i * c1i;
+            y1i[q] = t1r * c1i + t1i * c1r;
+            y2r[q] = t2r * c2r - t2i * c2i;
+            y2i[q] = t2r * c2i + t2i * c2r;
+            y3r[q] = t3r * c3r - t3i * c3i;
+            y3i[q] = t3r * c3i + t3i * c3r;
+        }
+    }
+}
+
+// odd prime radix r: a direct r-point DFT per butterfly, O(r^2)
+void radixGeneric(const Pass& a, int r, size_t p0, size_t p1, size_t q0, size_t q1) {
+    const size_t m = a.m, s = a.s;
+    float tr[FftPlan::kMaxRadix], ti[FftPlan::kMaxRadix];
+    for (size_t p = p0; p < p1; p++) {
+        size_t q = q0;
+#ifdef __SSE2__
+        // four sub-transforms at once, roots and twiddles broadcast
+        __m128 vr[FftPlan::kMaxRadix], vi[FftPlan::kMaxRadix];
+        for (; q + 4 <= q1; q += 4) {
+            for (int k = 0; k < r; k++) {
+                vr[k] = _mm_loadu_ps(a.xr + q + s * (p + k * m));
+                vi[k] = _mm_loadu_ps(a.xi + q + s * (p + k * m));
+            }
+            for (int j = 0; j < r; j++) {
+                __m128 sr = _mm_setzero_ps(), si = _mm_setzero_ps();
+                int idx = 0; // j*k mod r
+                for (int k = 0; k < r; k++) {
+                    __m128 tr, ti;
+                    cmul(vr[k], vi[k], _mm_set1_ps(a.rr[idx]), _mm_set1_ps(a.ri[idx]), tr, ti);
+                    sr = _mm_add_ps(sr, tr);
+                    si = _mm_add_ps(si, ti);
+                    idx += j;
+                    if (idx >= r) idx -= r;
+                }
+                size_t out = q + s * (r * p + j);
+                if (j > 0) {
+                    cmul(sr, si, _mm_set1_ps(a.wr[(j - 1) * m + p]), _mm_set1_ps(a.wi[(j - 1) * m + p]), sr, si);
+                }
+                _mm_storeu_ps(a.yr + out, sr);
+                _mm_storeu_ps(a.yi + out, si);
+            }
+        }
+#endif
+        for (; q < q1; q++) {
+            for (int k = 0; k < r; k++) {
+                tr[k] = a.xr[q + s * (p + k * m)];
+                ti[k] = a.xi[q + s * (p + k * m)];
+            }
+            for (int j = 0; j < r; j++) {
+                float sr = 0, si = 0;
+                int idx = 0; // j*k mod r
+                for (int k = 0; k < r; k++) {
+                    sr += tr[k] * a.rr[idx] - ti[k] * a.ri[idx];
+                    si += tr[k] * a.ri[idx] + ti[k] * a.rr[idx];
+                    idx += j;
+                    if (idx >= r) idx -= r;
+                }
+                size_t out = q + s * (r * p + j);
+                if (j == 0) {
+                    a.yr[out] = sr;
+                    a.yi[out] = si;
+                } else {
+                    float cr = a.wr[(j - 1) * m + p], ci = a.wi[(j - 1) * m + p];
+                    a.yr[out] = sr * cr - si * ci;
+                    a.yi[out] = sr * ci + si * cr;
+                }
+            }
+        }
+    }
+}
+
+// exp(-2 pi i num / den), computed in double and rounded once
+std::pair<float, float> unitRoot(size_t num, size_t den) {
+    double angle = -2.0 * std::numbers::pi * (double)num / (double)den;
+    return {(float)std::cos(angle), (float)std::sin(angle)};
+}
+
+// per-size cache shared by both plan types; the plan is built outside the
+// lock because a Bluestein or real plan fetches another plan while building
+template <typename Plan>
+std::shared_ptr<const Plan> cachedPlan(size_t n) {
+    static std::mutex mutex;
+    static std::map<size_t, std::shared_ptr<const Plan>> cache;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = cache.find(n);
+        if (it != cache.end()) return it->second;
+    }
+    auto plan = std::make_shared<const Plan>(n);
+    std::lock_guard<std::mutex> lock(mutex);
+    return cache.emplace(n, std::move(plan)).first->second;
+}
+
+} // namespace
+
+SplitComplex::SplitComplex(std::span<const Complex> values) : re(values.size()), im(values.size()) {
+    for (size_t i = 0; i < values.size(); i++) set(i, values[i]);
+}
+
+std::vector<Complex> SplitComplex::toComplex() const {
+    std::vector<Complex> out;
+    out.reserve(getSize());
+    for (size_t i = 0; i < getSize(); i++) out.push_back(get(i));
+    return out;
+}
+
+FftPlan::FftPlan(size_t n) : size(n) {
+    if (n == 0) throw std::invalid_argument("FftPlan: size must be positive");
+    INSTR_COUNT("fft.plan.build");
+
+    size_t rest = n;
+    while (rest % 4 == 0) {
+        factors.push_back(4);
+        rest /= 4;
+    }
+    if (rest % 2 == 0) {
+        factors.push_back(2);
+        rest /= 2;
+    }
+    for (int p = 3; p <= kMaxRadix && rest > 1; p += 2) {
+        while (rest % p == 0) {
+            factors.push_back(p);
+            rest /= p;
+        }
+    }
+
+    if (rest > 1) {
+        // a prime factor too large for a direct butterfly
+        factors.clear();
+        bluestein = std::make_unique<Bluestein>();
+        size_t m = 1;
+        while (m < 2 * n - 1) m *= 2;
+        bluestein->inner = get(m);
+        bluestein->chirpRe.resize(n);
+        bluestein->chirpIm.resize(n);
+        bluestein->kernelRe.assign(m, 0);
+        bluestein->kernelIm.assign(m, 0);
+        for (size_t k = 0; k < n; k++) {
+            // exp(-i pi k^2 / n) = exp(-2 pi i (k^2 mod 2n) / 2n), reduced first to keep the angle exact
+            auto [c, s] = unitRoot((k * k) % (2 * n), 2 * n);
+            bluestein->chirpRe[k] = c;
+            bluestein->chirpIm[k] = s;
+            bluestein->kernelRe[k] = c;
+            bluestein->kernelIm[k] = -s;
+            if (k > 0) {
+                bluestein->kernelRe[m - k] = c;
+                bluestein->kernelIm[m - k] = -s;
+            }
+        }
+        bluestein->inner->forward(bluestein->kernelRe.data(), bluestein->kernelIm.data());
+        return;
+    }
+
+    size_t length = n, stride = 1;
+    for (int r : factors) {
+        size_t m = length / r;
+        stages.push_back({r, length, stride, twiddleRe.size()});
+        for (int j = 1; j < r; j++) {
+            for (size_t p = 0; p < m; p++) {
+                auto [c, s] = unitRoot(p * j, length);
+                twiddleRe.push_back(c);
+                twiddleIm.push_back(s);
+            }
+        }
+        rootOffset.push_back(rootRe.size());
+        if (r != 2 && r != 4) {
+            for (int k = 0; k < r; k++) {
+                auto [c, s] = unitRoot(k, r);
+                rootRe.push_back(c);
+                rootIm.push_back(s);
+            }
+        }
+        length = m;
+        stride *= r;
+    }
+}
+
+std::shared_ptr<const FftPlan> FftPlan::get(size_t n) {
+    return cachedPlan<FftPlan>(n);
+}
+
+void FftPlan::forward(float* re, float* im, ThreadPool& pool) const {
+    INSTR_SCOPE("fft.forward");
+    if (bluestein) {
+        runBluestein(re, im, pool);
+    } else {
+        runStages(re, im, pool);
+    }
+}
+
+void FftPlan::inverse(float* re, float* im, ThreadPool& pool) const {
+    // the inverse DFT is the forward one with real and imaginary swapped
+    // on the way in and out, then scaled
+    forward(im, re, pool);
+    float scale = 1.0f / (float)size;
+    for (size_t i = 0; i < size; i++) {
+        re[i] *= scale;
+        im[i] *= scale;
+    }
+}
+
+void FftPlan::runStages(float* re, float* im, ThreadPool& pool) const {
+    if (stages.empty()) return; // size 1
+    thread_local std::vector<float> scratch;
+    if (scratch.size() < 2 * size) scratch.resize(2 * size);
+
+    float* bufR[2] = {re, scratch.data()};
+    float* bufI[2] = {im, scratch.data() + size};
+    bool threaded = (long)size >= parallel::kParallelThreshold && pool.getThreadCount() > 1;
+    int from = 0;
+    for (size_t i = 0; i < stages.size(); i++) {
+        const Stage& st = stages[i];
+        Pass pass = {bufR[from], bufI[from], bufR[1 - from], bufI[1 - from],
+                     twiddleRe.data() + st.twiddle, twiddleIm.data() + st.twiddle,
+                     rootRe.data() + rootOffset[i], rootIm.data() + rootOffset[i],
+                     st.length / st.radix, st.stride};
+        auto work = [&](size_t p0, size_t p1, size_t q0, size_t q1) {
+            switch (st.radix) {
+            case 2: radix2(pass, p0, p1, q0, q1); break;
+            case 4: radix4(pass, p0, p1, q0, q1); break;
+            default: radixGeneric(pass, st.radix, p0, p1, q0, q1); break;
+            }
+        };
+        if (!threaded) {
+            work(0, pass.m, 0, pass.s);
+        } else {
+            // early stages have few long sub-transforms, late ones many short ones
+            int chunks = parallel::chunkCount((long)size, pool);
+            bool splitP = pass.m >= pass.s;
+            size_t range = splitP ? pass.m : pass.s;
+            pool.run(chunks, [&](int c) {
+                size_t b = range * c / chunks, e = range * (c + 1) / chunks;
+                if (splitP) {
+                    work(b, e, 0, pass.s);
+                } else {
+                    work(0, pass.m, b, e);
+                }
+            });
+        }
+        from = 1 - from;
+    }
+    if (from == 1) {
+        std::copy(bufR[1], bufR[1] + size, re);
+        std::copy(bufI[1], bufI[1] + size, im);
+    }
+}
+
+void FftPlan::runBluestein(float* re, float* im, ThreadPool& pool) const {
+    const Bluestein& b = *bluestein;
+    size_t m = b.inner->getSize();
+    std::vector<float> ar(m, 0.0f), ai(m, 0.0f);
+    for (size_t k = 0; k < size; k++) {
+        ar[k] = re[k] * b.chirpRe[k] - im[k] * b.chirpIm[k];
+        ai[k] = re[k] * b.chirpIm[k] + im[k] * b.chirpRe[k];
+    }
+    b.inner->forward(ar.data(), ai.data(), pool);
+    for (size_t k = 0; k < m; k++) {
+        float r = ar[k] * b.kernelRe[k] - ai[k] * b.kernelIm[k];
+        float i = ar[k] * b.kernelIm[k] + ai[k] * b.kernelRe[k];
+        ar[k] = r;
+        ai[k] = i;
+    }
+    b.inner->inverse(ar.data(), ai.data(), pool);
+    for (size_t k = 0; k < size; k++) {
+        re[k] = ar[k] * b.chirpRe[k] - ai[k] * b.chirpIm[k];
+        im[k] = ar[k] * b.chirpIm[k] + ai[k] * b.chirpRe[k];
+    }
+}
+
+RealFftPlan::RealFftPlan(size_t n) : size(n) {
+    if (n == 0) throw std::invalid_argument("RealFftPlan: size must be positive");
+    if (n % 2 != 0) {
+        complexPlan = FftPlan::get(n);
+        return;
+    }
+    size_t half = n / 2;
+    complexPlan = FftPlan::get(half);
+    for (size_t k = 0; k <= half / 2; k++) {
+        auto [c, s] = unitRoot(k, n);
+        twiddleRe.push_back(c);
+        twiddleIm.push_back(s);
+    }
+}
+
+std::shared_ptr<const RealFftPlan> RealFftPlan::get(size_t n) {
+    return cachedPlan<RealFftPlan>(n);
+}
+
+// Even n: z[k] = x[2k] + i x[2k+1] transforms to Z, and with
+// E = (Z[k] + conj(Z[h-k])) / 2 and O = -i (Z[k] - conj(Z[h-k])) / 2
+// (the spectra of the even and odd samples),
+//   X[k] = E + w^k O,  X[h-k] = conj(E - w^k O),  h = n/2
+void RealFftPlan::forward(const float* in, float* outRe, float* outIm, ThreadPool& pool) const {
+    INSTR_SCOPE("fft.real_forward");
+    if (size % 2 != 0) {
+        std::vector<float> re(in, in + size), im(size, 0.0f);
+        complexPlan->forward(re.data(), im.data(), pool);
+        std::copy(re.begin(), re.begin() + getBinCount(), outRe);
+        std::copy(im.begin(), im.begin() + getBinCount(), outIm);
+        return;
+    }
+    size_t half = size / 2;
+    for (size_t k = 0; k < half; k++) {
+        outRe[k] = in[2 * k];
+        outIm[k] = in[2 * k + 1];
+    }
+    complexPlan->forward(outRe, outIm, pool);
+
+    float z0r = outRe[0], z0i = outIm[0];
+    outRe[0] = z0r + z0i;
+    outIm[0] = 0;
+    outRe[half] = z0r - z0i;
+    outIm[half] = 0;
+    for (size_t k = 1; k <= half / 2; k++) {
+        size_t l = half - k;
+        float ar = outRe[k], ai = outIm[k], br = outRe[l], bi = outIm[l];
+        float er = (ar + br) * 0.5f, ei = (ai - bi) * 0.5f;
+        float orr = (ai + bi) * 0.5f, oi = (br - ar) * 0.5f;
+        float c = twiddleRe[k], s = twiddleIm[k];
+        float tr = orr * c - oi * s, ti = orr * s + oi * c;
+        outRe[k] = er + tr;
+        outIm[k] = ei + ti;
+        outRe[l] = er - tr;
+        outIm[l] = ti - ei;
+    }
+}
+
+// runs forward's post-processing backwards: rebuild E and O from the
+// bins, Z = E + i O, then one half-size inverse transform
+void RealFftPlan::inverse(const float* inRe, const float* inIm, float* out, ThreadPool& pool) const {
+    INSTR_SCOPE("fft.real_inverse");
+    if (size % 2 != 0) {
+        std::vector<float> re(size), im(size);
+        for (size_t k = 0; k < getBinCount(); k++) {
+            re[k] = inRe[k];
+            im[k] = inIm[k];
+            if (k > 0) {
+                re[size - k] = inRe[k];
+                im[size - k] = -inIm[k];
+            }
+        }
+        complexPlan->inverse(re.data(), im.data(), pool);
+        std::copy(re.begin(), re.end(), out);
+        return;
+    }
+    size_t half = size / 2;
+    std::vector<float> zr(half), zi(half);
+    {
+        float er = (inRe[0] + inRe[half]) * 0.5f, ei = (inIm[0] - inIm[half]) * 0.5f;
+        float orr = (inRe[0] - inRe[half]) * 0.5f, oi = (inIm[0] + inIm[half]) * 0.5f;
+        zr[0] = er - oi;
+        zi[0] = ei + orr;
+    }
+    for (size_t k = 1; k <= half / 2; k++) {
+        size_t l = half - k;
+        float ar = inRe[k], ai = inIm[k], br = inRe[l], bi = inIm[l];
+        float er = (ar + br) * 0.5f, ei = (ai - bi) * 0.5f;
+        float dr = (ar - br) * 0.5f, di = (ai + bi) * 0.5f;
+        float c = twiddleRe[k], s = twiddleIm[k];
+        float orr = dr * c + di * s, oi = di * c - dr * s; // times conj(w^k)
+        zr[k] = er - oi;
+        zi[k] = ei + orr;
+        zr[l] = er + oi;
+        zi[l] = orr - ei;
+    }
+    complexPlan->inverse(zr.data(), zi.data(), pool);
+    for (size_t k = 0; k < half; k++) {
+        out[2 * k] = zr[k];
+        out[2 * k + 1] = zi[k];
+    }
+}
+
+std::vector<Complex> fft(std::span<const Complex> x) {
+    if (x.empty()) return {};
+    SplitComplex data(x);
+    FftPlan::get(x.size())->forward(data);
+    return data.toComplex();
+}
+
+std::vector<Complex> ifft(std::span<const Complex> x) {
+    if (x.empty()) return {};
+    SplitComplex data(x);
+    FftPlan::get(x.size())->inverse(data);
+    return data.toComplex();
+}
+
+void naiveDft(const float* re, const float* im, size_t n, double* outRe, double* outIm) {
+    std::vector<double> c(n), s(n);
+    for (size_t k = 0; k < n; k++) {
+        double angle = -2.0 * std::numbers::pi * (double)k / (double)n;
+        c[k] = std::cos(angle);
+        s[k] = std::sin(angle);
+    }
+    for (size_t k = 0; k < n; k++) {
+        double sr = 0, si = 0;
+        size_t idx = 0; // j*k mod n
+        for (size_t j = 0; j < n; j++) {
+            sr += re[j] * c[idx] - im[j] * s[idx];
+            si += re[j] * s[idx] + im[j] * c[idx];
+            idx += k;
+            if (idx >= n) idx -= n;
+        }
+        outRe[k] = sr;
+        outIm[k] = si;
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "library.h"
+#include "thread_pool.h"
+
+// Complex samples in split layout: all real parts in one array, all
+// imaginary parts in another. Butterflies then work on plain float
+// arrays, so the compiler can load four reals (or imaginaries) per SSE
+// register instead of shuffling interleaved pairs apart.
+class SplitComplex {
+public:
+    std::vector<float> re;
+    std::vector<float> im;
+
+    SplitComplex() = default;
+    explicit SplitComplex(size_t n) : re(n), im(n) {}
+    explicit SplitComplex(std::span<const Complex> values);
+
+    size_t getSize() const { return re.size(); }
+    Complex get(size_t i) const { return Complex(re[i], im[i]); }
+    void set(size_t i, Complex c) { re[i] = c.getReal(); im[i] = c.getImag(); }
+    std::vector<Complex> toComplex() const;
+};
+
+// Precomputed plan for complex transforms of one size.
+//
+// The size is factored into radix-4 and radix-2 stages, then odd primes
+// up to kMaxRadix with a generic radix-p butterfly. Stages run in
+// Stockham order, ping-ponging between the data and a scratch buffer, so
+// there is no bit-reversal pass. A size with a prime factor above
+// kMaxRadix goes through Bluestein's algorithm: a convolution done with a
+// power-of-two plan, O(n log n) for any n.
+//
+// Plans are immutable once built and can be shared across threads; get()
+// caches one per size. forward() is unnormalised, inverse() scales by
+// 1/n, so inverse(forward(x)) == x. Sizes of at least
+// parallel::kParallelThreshold split each stage across the pool.
+class FftPlan {
+public:
+    static const int kMaxRadix = 32;
+
+    explicit FftPlan(size_t n);
+    static std::shared_ptr<const FftPlan> get(size_t n);
+
+    size_t getSize() const { return size; }
+    const std::vector<int>& getFactors() const { return factors; } // radix of each stage
+    bool usesBluestein() const { return bluestein != nullptr; }
+
+    // in place on split arrays of getSize() floats each
+    void forward(float* re, float* im, ThreadPool& pool = ThreadPool::shared()) const;
+    void inverse(float* re, float* im, ThreadPool& pool = ThreadPool::shared()) const;
+
+    void forward(SplitComplex& x, ThreadPool& pool = ThreadPool::shared()) const { forward(x.re.data(), x.im.data(), pool); }
+    void inverse(SplitComplex& x, ThreadPool& pool = ThreadPool::shared()) const { inverse(x.re.data(), x.im.data(), pool); }
+
+private:
+    struct Stage {
+        int radix;
+        size_t length;  // length of each sub-transform at this stage
+        size_t stride;  // number of interleaved sub-transforms
+        size_t twiddle; // offset of this stage's twiddles, (radix-1) x length/radix
+    };
+
+    // Bluestein: x * chirp, convolved with conj(chirp) through a
+    // power-of-two plan, times chirp again
+    struct Bluestein {
+        std::shared_ptr<const FftPlan> inner;
+        std::vector<float> chirpRe, chirpIm;   // exp(-i pi k^2 / n), k < n
+        std::vector<float> kernelRe, kernelIm; // forward transform of conj(chirp), wrapped
+    };
+
+    size_t size;
+    std::vector<int> factors;
+    std::vector<Stage> stages;
+    std::vector<float> twiddleRe, twiddleIm;
+    std::vector<float> rootRe, rootIm; // exp(-2 pi i k / r) for each generic radix r, by stage
+    std::vector<size_t> rootOffset;
+    std::unique_ptr<Bluestein> bluestein;
+
+    void runStages(float* re, float* im, ThreadPool& pool) const;
+    void runBluestein(float* re, float* im, ThreadPool& pool) const;
+};
+
+// Transforms of n real samples to the n/2+1 non-redundant bins (the rest
+// are conjugates). Even n packs pairs of samples into one complex value
+// and runs a half-size complex plan, roughly halving the work. Odd n
+// falls back to a full complex transform.
+class RealFftPlan {
+public:
+    explicit RealFftPlan(size_t n);
+    static std::shared_ptr<const RealFftPlan> get(size_t n);
+
+    size_t getSize() const { return size; }
+    size_t getBinCount() const { return size / 2 + 1; }
+
+    // in: getSize() samples; outRe/outIm: getBinCount() bins each
+    void forward(const float* in, float* outRe, float* outIm, ThreadPool& pool = ThreadPool::shared()) const;
+    // inverse of forward, including the 1/n scaling; out: getSize() samples
+    void inverse(const float* inRe, const float* inIm, float* out, ThreadPool& pool = ThreadPool::shared()) const;
+
+private:
+    size_t size;
+    std::shared_ptr<const FftPlan> complexPlan; // size/2 for even sizes, size for odd ones
+    std::vector<float> twiddleRe, twiddleIm;   // exp(-2 pi i k / n), k <= n/4
+};
+
+// convenience wrappers over the cached plans
+std::vector<Complex> fft(std::span<const Complex> x);
+std::vector<Complex> ifft(std::span<const Complex> x);
+
+// O(n^2) DFT computed in double precision, the reference the plans are
+// checked against
+void naiveDft(const float* re, const float* im, size_t n, double* outRe, double* outIm);
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Lazy sequence produced by a C++20 coroutine that co_yields values.
+//
+// Nothing runs until the first begin(); each ++ resumes the coroutine up
+// to its next co_yield. Values are handed out by reference to the object
+// the coroutine yielded, which stays alive while the coroutine is
+// suspended, so a chain of stages passes each element along without
+// copying it or building a container in between. An exception thrown in
+// the coroutine comes out of begin() or ++.
+//
+// Generators are move-only and single-pass, like an input range:
+//    for (const int& v : lazy::values(vec) | lazy::filter(isOdd) | lazy::take(10)) ...
+template <typename T>
+class Generator {
+public:
+    using value_type = std::remove_cvref_t<T>;
+    using reference = const value_type&;
+
+    struct promise_type {
+        const value_type* current = nullptr;
+        std::exception_ptr error;
+
+        Generator get_return_object() { return Generator(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        // a temporary yielded here lives until the coroutine resumes
+        std::suspend_always yield_value(const value_type& v) noexcept {
+            current = std::addressof(v);
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+        // generators are synchronous; use Task for anything that awaits
+        template <typename U>
+        std::suspend_never await_transform(U&&) = delete;
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    class iterator {
+        Handle h;
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = Generator::value_type;
+
+        iterator() = default;
+        explicit iterator(Handle handle) : h(handle) {}
+
+        reference operator*() const { return *h.promise().current; }
+        const value_type* operator->() const { return h.promise().current; }
+        iterator& operator++() {
+            advance(h);
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+        bool operator==(std::default_sentinel_t) const { return !h || h.done(); }
+    };
+
+    Generator() = default;
+    Generator(Generator&& other) noexcept : h(std::exchange(other.h, {})) {}
+    Generator& operator=(Generator&& other) noexcept {
+        if (this != &other) {
+            if (h) h.destroy();
+            h = std::exchange(other.h, {});
+        }
+        return *this;
+    }
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    ~Generator() {
+        if (h) h.destroy();
+    }
+
+    // runs the coroutine to its first co_yield; call once
+    iterator begin() {
+        if (h) advance(h);
+        return iterator(h);
+    }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    Handle h;
+
+    explicit Generator(Handle handle) : h(handle) {}
+
+    static void advance(Handle handle) {
+        handle.resume();
+        if (handle.done() && handle.promise().error) {
+            std::rethrow_exception(handle.promise().error);
+        }
+    }
+};
+
+// Sources, stages and sinks for Generator pipelines.
+//
+// Stages take their upstream generator by value (it moves into the
+// coroutine frame) and can be called directly, map(src, fn), or chained
+// with |, src | map(fn). Sources that read a container keep a reference
+// to it: the container must outlive the pipeline.
+namespace lazy {
+
+// elements of any range with begin()/end(): Vector, std::vector<Book>, ...
+template <typename Range>
+auto values(const Range& range) -> Generator<std::remove_cvref_t<decltype(*std::begin(range))>> {
+    for (const auto& v : range) co_yield v;
+}
+template <typename Range>
+void values(const Range&& range) = delete; // would dangle
+
+// first, first+1, ..., last-1 without storing them
+inline Generator<long> range(long first, long last) {
+    for (long i = first; i < last; i++) co_yield i;
+}
+
+template <typename T, typename Fn>
+auto map(Generator<T> src, Fn fn) -> Generator<std::remove_cvref_t<std::invoke_result_t<Fn&, const T&>>> {
+    for (const auto& v : src) co_yield fn(v);
+}
+
+template <typename T, typename Pred>
+Generator<T> filter(Generator<T> src, Pred pred) {
+    for (const auto& v : src) {
+        if (pred(v)) co_yield v;
+    }
+}
+
+// stops after n values without pulling an n+1th from upstream
+template <typename T>
+Generator<T> take(Generator<T> src, size_t n) {
+    if (n == 0) co_return;
+    for (const auto& v : src) {
+        co_yield v;
+        if (--n == 0) co_return;
+    }
+}
+
+// groups of up to size values; the last group may be short. The
+// yielded vector is reused for the next group.
+template <typename T>
+Generator<std::vector<std::remove_cvref_t<T>>> batch(Generator<T> src, size_t size) {
+    std::vector<std::remove_cvref_t<T>> group;
+    group.reserve(size);
+    for (const auto& v : src) {
+        group.push_back(v);
+        if (group.size() == size) {
+            co_yield group;
+            group.clear();
+        }
+    }
+    if (!group.empty()) co_yield group;
+}
+
+// a stage waiting for its upstream, for the | syntax
+template <typename Apply>
+struct Stage {
+    Apply apply;
+};
+
+template <typename T, typename Apply>
+auto operator|(Generator<T> src, Stage<Apply> stage) {
+    return stage.apply(std::move(src));
+}
+
+template <typename Fn>
+auto map(Fn fn) {
+    return Stage{[fn](auto src) { return map(std::move(src), fn); }};
+}
+
+template <typename Pred>
+auto filter(Pred pred) {
+    return Stage{[pred](auto src) { return filter(std::move(src), pred); }};
+}
+
+inline auto take(size_t n) {
+    return Stage{[n](auto src) { return take(std::move(src), n); }};
+}
+
+inline auto batch(size_t size) {
+    return Stage{[size](auto src) { return batch(std::move(src), size); }};
+}
+
+// sinks: drain the pipeline
+
+template <typename T>
+std::vector<std::remove_cvref_t<T>> collect(Generator<T> src) {
+    std::vector<std::remove_cvref_t<T>> out;
+    for (const auto& v : src) out.push_back(v);
+    return out;
+}
+
+template <typename T, typename Acc, typename Op>
+Acc fold(Generator<T> src, Acc init, Op op) {
+    for (const auto& v : src) init = op(std::move(init), v);
+    return init;
+}
+
+} // namespace lazy
@@ -0,0 +1,208 @@
+#include "instrument.h"
+
+#ifdef PRACTICE_INSTRUMENT
+
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace instr {
+
+namespace {
+
+// cap on trace events kept per thread, anything past this is only counted
+const size_t kMaxEventsPerThread = 1 << 20;
+
+struct Event {
+    const char* name;
+    uint64_t beginNs;
+    uint64_t durNs;
+};
+
+struct ThreadData {
+    int tid = 0;
+    std::vector<std::unique_ptr<Stat>> stats; // unique_ptr keeps Stat* stable
+    std::vector<Event> events;
+    uint64_t droppedEvents = 0;
+};
+
+// Every thread's data is owned here and never freed, so samples from
+// threads that already exited still show up in the dumps.
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadData>>& registry() {
+    static std::vector<std::unique_ptr<ThreadData>> threads;
+    return threads;
+}
+
+ThreadData* registerThread() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto& threads = registry();
+    threads.push_back(std::make_unique<ThreadData>());
+    threads.back()->tid = (int)threads.size();
+    return threads.back().get();
+}
+
+ThreadData& thisThread() {
+    static thread_local ThreadData* mine = registerThread();
+    return *mine;
+}
+
+int bucketFor(uint64_t ns) {
+    int b = 63 - __builtin_clzll(ns | 1);
+    return b < kHistogramBuckets ? b : kHistogramBuckets - 1;
+}
+
+void merge(Stat& into, const Stat& from) {
+    into.count += from.count;
+    into.totalNs += from.totalNs;
+    if (from.minNs < into.minNs) into.minNs = from.minNs;
+    if (from.maxNs > into.maxNs) into.maxNs = from.maxNs;
+    for (int i = 0; i < kHistogramBuckets; i++) {
+        into.histogram[i] += from.histogram[i];
+    }
+}
+
+void writeEscaped(std::ostream& out, const char* s) {
+    out << '"';
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') out << '\\';
+        out << *s;
+    }
+    out << '"';
+}
+
+} // namespace
+
+uint64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+Stat* slot(const char* name) {
+    ThreadData& td = thisThread();
+    for (auto& s : td.stats) {
+        if (s->name == name || std::strcmp(s->name, name) == 0) {
+            return s.get();
+        }
+    }
+    // other threads only read stats during a dump, so no lock is needed
+    // beyond the one taken when this thread registered
+    td.stats.push_back(std::make_unique<Stat>());
+    td.stats.back()->name = name;
+    return td.stats.back().get();
+}
+
+void record(Stat* s, uint64_t beginNs, uint64_t endNs) {
+    uint64_t dur = endNs - beginNs;
+    s->count++;
+    s->totalNs += dur;
+    if (dur < s->minNs) s->minNs = dur;
+    if (dur > s->maxNs) s->maxNs = dur;
+    s->histogram[bucketFor(dur)]++;
+
+    ThreadData& td = thisThread();
+    if (td.events.size() < kMaxEventsPerThread) {
+        td.events.push_back({s->name, beginNs, dur});
+    } else {
+        td.droppedEvents++;
+    }
+}
+
+bool dumpJson(const char* path) {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::map<std::string, Stat> merged;
+    uint64_t dropped = 0;
+    for (auto& td : registry()) {
+        for (auto& s : td->stats) {
+            Stat& m = merged[s->name];
+            m.name = s->name;
+            merge(m, *s);
+        }
+        dropped += td->droppedEvents;
+    }
+
+    out << "{\n  \"threads\": " << registry().size()
+        << ",\n  \"dropped_events\": " << dropped
+        << ",\n  \"stats\": [";
+    bool first = true;
+    for (auto& entry : merged) {
+        const Stat& s = entry.second;
+        out << (first ? "\n" : ",\n") << "    {\"name\": ";
+        first = false;
+        writeEscaped(out, s.name);
+        out << ", \"count\": " << s.count;
+        if (s.totalNs > 0 || s.maxNs > 0) { // timers only
+            out << ", \"total_ns\": " << s.totalNs
+                << ", \"min_ns\": " << s.minNs
+                << ", \"max_ns\": " << s.maxNs
+                << ", \"mean_ns\": " << (s.count ? s.totalNs / s.count : 0)
+                << ", \"histogram_log2_ns\": [";
+            int last = kHistogramBuckets - 1;
+            while (last > 0 && s.histogram[last] == 0) last--;
+            for (int i = 0; i <= last; i++) {
+                out << (i ? ", " : "") << s.histogram[i];
+            }
+            out << "]";
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+    return (bool)out;
+}
+
+bool dumpChromeTrace(const char* path) {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    uint64_t origin = UINT64_MAX;
+    for (auto& td : registry()) {
+        for (auto& e : td->events) {
+            if (e.beginNs < origin) origin = e.beginNs;
+        }
+    }
+
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    bool first = true;
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    for (auto& td : registry()) {
+        for (auto& e : td->events) {
+            out << (first ? "\n" : ",\n") << "{\"name\": ";
+            first = false;
+            writeEscaped(out, e.name);
+            // trace-event timestamps are in microseconds
+            out << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << td->tid
+                << ", \"ts\": " << (e.beginNs - origin) / 1000.0
+                << ", \"dur\": " << e.durNs / 1000.0 << "}";
+        }
+    }
+    out << "\n]}\n";
+    return (bool)out;
+}
+
+void reset() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& td : registry()) {
+        for (auto& s : td->stats) {
+            const char* name = s->name;
+            *s = Stat();
+            s->name = name;
+        }
+        td->events.clear();
+        td->droppedEvents = 0;
+    }
+}
+
+} // namespace instr
+
+#endif
@@ -0,0 +1,94 @@
+#pragma once
+
+// Hot-path instrumentation: event counters, scoped timers with per-thread
+// latency histograms, and a trace-event log that can be dumped as JSON or
+// as a Chrome trace (open it in chrome://tracing or ui.perfetto.dev).
+//
+// Everything compiles out unless PRACTICE_INSTRUMENT is defined, so the
+// macros below cost nothing in a normal build:
+//    INSTR_COUNT("vector.push_back");        // bump a counter
+//    INSTR_COUNT_N("vector.copy_bytes", n);  // bump a counter by n
+//    INSTR_SCOPE("vector.grow");             // time the rest of the scope
+//    INSTR_DUMP_JSON("stats.json");          // write counters + histograms
+//    INSTR_DUMP_TRACE("trace.json");         // write Chrome trace events
+//
+// Names must be string literals (or otherwise live for the whole program).
+// Each call site caches a pointer to its per-thread slot, so the hot path
+// is one thread_local load plus an add; no locks, no map lookups.
+
+#include <cstdint>
+
+#define INSTR_CAT_(a, b) a##b
+#define INSTR_CAT(a, b) INSTR_CAT_(a, b)
+
+#ifdef PRACTICE_INSTRUMENT
+
+namespace instr {
+
+// log2 buckets: bucket i holds durations in [2^i, 2^(i+1)) nanoseconds
+const int kHistogramBuckets = 48;
+
+struct Stat {
+    const char* name = nullptr;
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t minNs = UINT64_MAX;
+    uint64_t maxNs = 0;
+    uint64_t histogram[kHistogramBuckets] = {};
+};
+
+// monotonic clock in nanoseconds (clock_gettime(CLOCK_MONOTONIC))
+uint64_t nowNs();
+
+// returns this thread's slot for name, creating it on first use
+Stat* slot(const char* name);
+
+// adds one timed sample to s and appends a trace event for it
+void record(Stat* s, uint64_t beginNs, uint64_t endNs);
+
+class ScopedTimer {
+    Stat* stat;
+    uint64_t begin;
+public:
+    explicit ScopedTimer(Stat* s) : stat(s), begin(nowNs()) {}
+    ~ScopedTimer() { record(stat, begin, nowNs()); }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+// Dumps merged counters and histograms (all threads) as JSON.
+// Call these while instrumented threads are idle; returns false on I/O error.
+bool dumpJson(const char* path);
+
+// Dumps the recorded timer samples in Chrome trace-event format.
+bool dumpChromeTrace(const char* path);
+
+// Clears every thread's counters and trace events.
+void reset();
+
+} // namespace instr
+
+#define INSTR_COUNT_N(name, n) \
+    do { \
+        static thread_local ::instr::Stat* instrSlot = ::instr::slot(name); \
+        instrSlot->count += (n); \
+    } while (0)
+
+#define INSTR_COUNT(name) INSTR_COUNT_N(name, 1)
+
+#define INSTR_SCOPE(name) \
+    static thread_local ::instr::Stat* INSTR_CAT(instrSlot_, __LINE__) = ::instr::slot(name); \
+    ::instr::ScopedTimer INSTR_CAT(instrTimer_, __LINE__)(INSTR_CAT(instrSlot_, __LINE__))
+
+#define INSTR_DUMP_JSON(path) ::instr::dumpJson(path)
+#define INSTR_DUMP_TRACE(path) ::instr::dumpChromeTrace(path)
+
+#else
+
+#define INSTR_COUNT_N(name, n) do { } while (0)
+#define INSTR_COUNT(name) do { } while (0)
+#define INSTR_SCOPE(name) do { } while (0)
+#define INSTR_DUMP_JSON(path) ((void)(path), true)
+#define INSTR_DUMP_TRACE(path) ((void)(path), true)
+
+#endif
@@ -0,0 +1,83 @@
+#include "intersect.h"
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+size_t intersectScalar(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+    size_t i = 0, j = 0, n = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (b[j] < a[i]) {
+            j++;
+        } else {
+            out[n++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    return n;
+}
+
+size_t intersectSimd(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+#ifdef __SSE2__
+    size_t i = 0, j = 0, n = 0;
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+        // compare each a lane against all four b lanes by rotating b
+        __m128i eq = _mm_cmpeq_epi32(va, vb);
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        while (mask) {
+            int lane = __builtin_ctz(mask);
+            out[n++] = a[i + lane];
+            mask &= mask - 1;
+        }
+        uint32_t amax = a[i + 3];
+        uint32_t bmax = b[j + 3];
+        if (amax <= bmax) i += 4;
+        if (bmax <= amax) j += 4;
+    }
+    return n + intersectScalar(a + i, na - i, b + j, nb - j, out + n);
+#else
+    return intersectScalar(a, na, b, nb, out);
+#endif
+}
+
+// for each element of the short list, gallop forward in the long one
+static size_t intersectGalloping(const uint32_t* small, size_t ns, const uint32_t* large, size_t nl, uint32_t* out) {
+    size_t n = 0, lo = 0;
+    for (size_t i = 0; i < ns && lo < nl; i++) {
+        uint32_t target = small[i];
+        size_t step = 1, hi = lo;
+        while (hi < nl && large[hi] < target) {
+            lo = hi + 1;
+            hi += step;
+            step *= 2;
+        }
+        hi = std::min(hi + 1, nl);
+        lo = std::lower_bound(large + lo, large + hi, target) - large;
+        if (lo < nl && large[lo] == target) {
+            out[n++] = target;
+            lo++;
+        }
+    }
+    return n;
+}
+
+size_t intersectSorted(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (na * 32 < nb) {
+        return intersectGalloping(a, na, b, nb, out);
+    }
+    return intersectSimd(a, na, b, nb, out);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Intersection of two strictly increasing uint32 lists. out needs room
+// for min(na, nb) values and must not overlap a or b; returns how many
+// were written.
+size_t intersectScalar(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out);
+
+// SSE2 block intersection (4x4 compare of every rotation per step);
+// falls back to intersectScalar on targets without SSE2
+size_t intersectSimd(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out);
+
+// picks the faster variant for the list shapes: galloping when one list
+// is much shorter, the SIMD kernel otherwise
+size_t intersectSorted(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// Encoding and POSIX I/O helpers shared by the on-disk formats in wal.cpp
+// and catalog.cpp, so both write the same bytes the same way.
+namespace io {
+
+// fixed-width integers in host order: little-endian hosts only, like the
+// rest of the file formats
+inline void putU32(std::string& out, uint32_t v) {
+    out.append((const char*)&v, 4);
+}
+
+inline void putU64(std::string& out, uint64_t v) {
+    out.append((const char*)&v, 8);
+}
+
+// what + path + strerror(errno); build it before errno changes
+inline std::runtime_error ioError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+// appends the rest of fd to out; false on a read error, with errno set
+inline bool readAll(int fd, std::string& out) {
+    char buf[1 << 16];
+    for (;;) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n > 0) {
+            out.append(buf, n);
+        } else if (n == 0) {
+            return true;
+        } else if (errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+// writes all len bytes; false on a write error, with errno set
+inline bool writeAll(int fd, const char* data, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t w = ::write(fd, data + done, len - done);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        done += w;
+    }
+    return true;
+}
+
+} // namespace io
@@ -0,0 +1,25 @@
+#include "library.h"
+
+#include "instrument.h"
+
+// Definition of static members
+std::atomic<int> Complex::objectCount{0};
+std::atomic<int> Book::bookCount{0};
+
+void Library::display(std::ostream& out) const {
+    out << "Library Name: " << name << ", Address: " << address << std::endl;
+}
+
+Book::Book(std::string t, std::string a) : title(std::move(t)), author(std::move(a)) {
+    INSTR_COUNT("book.construct");
+    id = ++bookCount; // Increment book count and assign ID
+}
+
+void Book::display(std::ostream& out) const {
+    out << "Book ID: " << id << ", Title: " << title << ", Author: " << author << std::endl;
+}
+
+void Magazine::display(std::ostream& out) const {
+    Book::display(out);
+    out << "Issue Number: " << issueNumber << std::endl;
+}
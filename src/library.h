@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+// Complex number and the library system from day 5.
+
+class Complex {
+  private:
+      float real;
+      float imag;
+      static std::atomic<int> objectCount; // Static member to count objects, atomic so any thread can construct Complex
+  public:
+      Complex(float r = 0, float i = 0) : real(r), imag(i) {
+          objectCount.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      float getReal() const { return real; }
+      float getImag() const { return imag; }
+
+      // Static member function to get the object count
+      static int getObjectCount() {
+          return objectCount.load(std::memory_order_relaxed);
+      }
+
+      // polar form: magnitude and angle in radians
+      static Complex polar(float magnitude, float angle) {
+          return Complex(magnitude * std::cos(angle), magnitude * std::sin(angle));
+      }
+
+      //overload operator +
+      Complex operator + (const Complex& obj) const {
+          return Complex(real + obj.real, imag + obj.imag);
+      }
+      Complex operator - (const Complex& obj) const {
+          return Complex(real - obj.real, imag - obj.imag);
+      }
+      Complex operator * (const Complex& obj) const {
+          return Complex(real * obj.real - imag * obj.imag, real * obj.imag + imag * obj.real);
+      }
+      Complex operator / (const Complex& obj) const {
+          float d = obj.norm();
+          return Complex((real * obj.real + imag * obj.imag) / d, (imag * obj.real - real * obj.imag) / d);
+      }
+      Complex operator * (float k) const { return Complex(real * k, imag * k); }
+      Complex operator / (float k) const { return Complex(real / k, imag / k); }
+      Complex operator - () const { return Complex(-real, -imag); }
+
+      Complex& operator += (const Complex& obj) { real += obj.real; imag += obj.imag; return *this; }
+      Complex& operator -= (const Complex& obj) { real -= obj.real; imag -= obj.imag; return *this; }
+      Complex& operator *= (const Complex& obj) { return *this = *this * obj; }
+      Complex& operator *= (float k) { real *= k; imag *= k; return *this; }
+      Complex& operator /= (float k) { real /= k; imag /= k; return *this; }
+
+      bool operator == (const Complex& obj) const { return real == obj.real && imag == obj.imag; }
+      bool operator != (const Complex& obj) const { return !(*this == obj); }
+
+      Complex conj() const { return Complex(real, -imag); }
+      float norm() const { return real * real + imag * imag; } // squared magnitude
+      float abs() const { return std::hypot(real, imag); }
+      float arg() const { return std::atan2(imag, real); }
+};
+
+inline Complex operator * (float k, const Complex& c) { return c * k; }
+
+class Library {
+  private:
+      std::string name;
+      std::string address;
+  public:
+      Library(std::string n, std::string a) : name(std::move(n)), address(std::move(a)) {}
+
+      const std::string& getName() const { return name; }
+      const std::string& getAddress() const { return address; }
+
+      void display(std::ostream& out = std::cout) const;
+};
+
+class Book {
+  private:
+      std::string title;
+      std::string author;
+      int id;
+      static std::atomic<int> bookCount; // Static member to count books, atomic so any thread can construct Books
+  public:
+      Book(std::string t, std::string a);
+
+      const std::string& getTitle() const { return title; }
+      const std::string& getAuthor() const { return author; }
+      int getId() const { return id; }
+
+      void display(std::ostream& out = std::cout) const;
+
+      // Static member function to get the book count
+      static int getBookCount() {
+          return bookCount;
+      }
+
+      // makes later Books get ids above id, e.g. after reloading a catalog
+      static void reserveIds(int id) {
+          int seen = bookCount.load();
+          while (seen < id && !bookCount.compare_exchange_weak(seen, id)) {
+          }
+      }
+};
+
+// A Book or Magazine as stored in a catalog
+struct CatalogEntry {
+    int id;
+    std::string title;
+    std::string author;
+    int issue; // -1 for a plain Book, else the Magazine issue number
+};
+
+class Magazine : public Book {
+  private:
+      int issueNumber;
+  public:
+      friend class Library; // If Library needs access to private members
+      Magazine(std::string t, std::string a, int issue) : Book(std::move(t), std::move(a)), issueNumber(issue) {}
+
+      int getIssueNumber() const { return issueNumber; }
+
+      void display(std::ostream& out = std::cout) const;
+};
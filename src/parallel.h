@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "thread_pool.h"
+#include "vector.h"
+
+// Parallel transform/sort/reduce over int ranges (and Vector). Ranges
+// shorter than kParallelThreshold, or a pool with one thread, run the
+// plain sequential algorithm.
+namespace parallel {
+
+const long kParallelThreshold = 1 << 16;
+
+// splits [0, n) into one chunk per thread (fewer for small n)
+inline int chunkCount(long n, const ThreadPool& pool) {
+    long chunks = std::min<long>(pool.getThreadCount(), n / (kParallelThreshold / 4) + 1);
+    return (int)std::max<long>(chunks, 1);
+}
+
+template <typename Fn>
+void transform(int* first, int* last, Fn fn, ThreadPool& pool = ThreadPool::shared()) {
+    long n = last - first;
+    if (n < kParallelThreshold || pool.getThreadCount() == 1) {
+        std::transform(first, last, first, fn);
+        return;
+    }
+    int chunks = chunkCount(n, pool);
+    pool.run(chunks, [&](int c) {
+        int* b = first + n * c / chunks;
+        int* e = first + n * (c + 1) / chunks;
+        std::transform(b, e, b, fn);
+    });
+}
+
+template <typename T, typename Op>
+T reduce(const int* first, const int* last, T init, Op op, ThreadPool& pool = ThreadPool::shared()) {
+    long n = last - first;
+    if (n < kParallelThreshold || pool.getThreadCount() == 1) {
+        for (const int* p = first; p != last; p++) init = op(init, *p);
+        return init;
+    }
+    int chunks = chunkCount(n, pool);
+    std::vector<T> partial(chunks);
+    pool.run(chunks, [&](int c) {
+        const int* b = first + n * c / chunks;
+        const int* e = first + n * (c + 1) / chunks;
+        T acc = *b++; // every chunk is non-empty, n >= threshold
+        for (; b != e; b++) acc = op(acc, *b);
+        partial[c] = acc;
+    });
+    for (const T& p : partial) init = op(init, p);
+    return init;
+}
+
+// sorts chunks in parallel, then merges neighbouring runs pairwise, each
+// round in parallel, bouncing between the input and one scratch buffer
+inline void sort(int* first, int* last, ThreadPool& pool = ThreadPool::shared()) {
+    long n = last - first;
+    if (n < kParallelThreshold || pool.getThreadCount() == 1) {
+        std::sort(first, last);
+        return;
+    }
+    int chunks = chunkCount(n, pool);
+    std::vector<long> bounds(chunks + 1);
+    for (int c = 0; c <= chunks; c++) bounds[c] = n * c / chunks;
+    pool.run(chunks, [&](int c) {
+        std::sort(first + bounds[c], first + bounds[c + 1]);
+    });
+
+    std::vector<int> scratch(n);
+    int* src = first;
+    int* dst = scratch.data();
+    for (int width = 1; width < chunks; width *= 2) {
+        int pairs = (chunks + 2 * width - 1) / (2 * width);
+        pool.run(pairs, [&](int p) {
+            int lo = p * 2 * width;
+            int mid = std::min(lo + width, chunks);
+            int hi = std::min(lo + 2 * width, chunks);
+            std::merge(src + bounds[lo], src + bounds[mid],
+                       src + bounds[mid], src + bounds[hi], dst + bounds[lo]);
+        });
+        std::swap(src, dst);
+    }
+    if (src != first) {
+        std::copy(src, src + n, first);
+    }
+}
+
+template <typename Fn>
+void transform(Vector& v, Fn fn, ThreadPool& pool = ThreadPool::shared()) {
+    transform(v.begin(), v.end(), fn, pool);
+}
+
+template <typename T, typename Op = std::plus<T>>
+T reduce(const Vector& v, T init, Op op = Op(), ThreadPool& pool = ThreadPool::shared()) {
+    return reduce(v.begin(), v.end(), init, op, pool);
+}
+
+inline void sort(Vector& v, ThreadPool& pool = ThreadPool::shared()) {
+    sort(v.begin(), v.end(), pool);
+}
+
+} // namespace parallel
@@ -0,0 +1,135 @@
+#include "point_store.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "instrument.h"
+
+namespace {
+
+// spreads the low 32 bits of v to the even bit positions
+uint64_t spreadBits(uint32_t v) {
+    uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000ffff0000ffffull;
+    x = (x | (x << 8)) & 0x00ff00ff00ff00ffull;
+    x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & 0x5555555555555555ull;
+    return x;
+}
+
+int bitWidth(uint32_t range) {
+    return range == 0 ? 0 : 32 - __builtin_clz(range);
+}
+
+void putBits(std::vector<uint8_t>& out, uint64_t& pos, uint32_t value, int width) {
+    for (int i = 0; i < width; i++, pos++) {
+        if (value >> i & 1) out[pos >> 3] |= (uint8_t)(1 << (pos & 7));
+    }
+}
+
+} // namespace
+
+uint64_t mortonCode(Point p) {
+    return spreadBits((uint32_t)p.x ^ 0x80000000u) | spreadBits((uint32_t)p.y ^ 0x80000000u) << 1;
+}
+
+PointStore::PointStore(std::vector<Point> points) : count(points.size()) {
+    INSTR_SCOPE("point_store.build");
+    std::vector<std::pair<uint64_t, Point>> keyed(points.size());
+    for (size_t i = 0; i < points.size(); i++) keyed[i] = {mortonCode(points[i]), points[i]};
+    std::sort(keyed.begin(), keyed.end(), [](auto& a, auto& b) { return a.first < b.first; });
+
+    // first pass: block boxes and widths, so the bit buffer is sized once
+    uint64_t totalBits = 0;
+    for (size_t start = 0; start < keyed.size(); start += kBlockSize) {
+        size_t end = std::min(keyed.size(), start + kBlockSize);
+        Block blk;
+        blk.minX = blk.maxX = keyed[start].second.x;
+        blk.minY = blk.maxY = keyed[start].second.y;
+        for (size_t i = start; i < end; i++) {
+            const Point& p = keyed[i].second;
+            blk.minX = std::min(blk.minX, p.x);
+            blk.maxX = std::max(blk.maxX, p.x);
+            blk.minY = std::min(blk.minY, p.y);
+            blk.maxY = std::max(blk.maxY, p.y);
+        }
+        blk.widthX = (uint8_t)bitWidth((uint32_t)blk.maxX - (uint32_t)blk.minX);
+        blk.widthY = (uint8_t)bitWidth((uint32_t)blk.maxY - (uint32_t)blk.minY);
+        blk.count = (uint16_t)(end - start);
+        blk.bitOffset = totalBits;
+        totalBits += (uint64_t)blk.count * (blk.widthX + blk.widthY);
+        blocks.push_back(blk);
+    }
+
+    bits.assign(totalBits / 8 + 1 + 8, 0);
+    for (size_t b = 0; b < blocks.size(); b++) {
+        const Block& blk = blocks[b];
+        uint64_t pos = blk.bitOffset;
+        for (size_t i = b * kBlockSize; i < b * kBlockSize + blk.count; i++) {
+            const Point& p = keyed[i].second;
+            putBits(bits, pos, (uint32_t)p.x - (uint32_t)blk.minX, blk.widthX);
+            putBits(bits, pos, (uint32_t)p.y - (uint32_t)blk.minY, blk.widthY);
+        }
+    }
+}
+
+size_t PointStore::getBytes() const {
+    return sizeof(*this) + blocks.capacity() * sizeof(Block) + bits.capacity();
+}
+
+int PointStore::decodeBlock(size_t b, Point* out) const {
+    const Block& blk = blocks[b];
+    const uint8_t* base = bits.data();
+    uint64_t pos = blk.bitOffset;
+    uint64_t maskX = blk.widthX ? (~0ull >> (64 - blk.widthX)) : 0;
+    uint64_t maskY = blk.widthY ? (~0ull >> (64 - blk.widthY)) : 0;
+    int width = blk.widthX + blk.widthY;
+    if (width <= 57) {
+        // common case: both fields fit in one unaligned 8-byte read
+        for (int i = 0; i < blk.count; i++, pos += width) {
+            uint64_t word;
+            std::memcpy(&word, base + (pos >> 3), 8);
+            word >>= pos & 7;
+            out[i].x = (int)((uint32_t)blk.minX + (uint32_t)(word & maskX));
+            out[i].y = (int)((uint32_t)blk.minY + (uint32_t)((word >> blk.widthX) & maskY));
+        }
+        return blk.count;
+    }
+    for (int i = 0; i < blk.count; i++) {
+        // widths are at most 32, so one unaligned 8-byte read covers a field
+        uint64_t word;
+        std::memcpy(&word, base + (pos >> 3), 8);
+        out[i].x = (int)((uint32_t)blk.minX + (uint32_t)((word >> (pos & 7)) & maskX));
+        pos += blk.widthX;
+        std::memcpy(&word, base + (pos >> 3), 8);
+        out[i].y = (int)((uint32_t)blk.minY + (uint32_t)((word >> (pos & 7)) & maskY));
+        pos += blk.widthY;
+    }
+    return blk.count;
+}
+
+long long PointStore::distanceSweep(Point origin) const {
+    long long total = 0;
+    forEachBlock([&](const Point* pts, int n) {
+        for (int i = 0; i < n; i++) total += distance(origin, pts[i]);
+    });
+    return total;
+}
+
+size_t PointStore::countWithin(Point center, int r2) const {
+    // a block is skipped when its box is farther than r2 from center
+    size_t found = 0;
+    Point buf[kBlockSize];
+    for (size_t b = 0; b < blocks.size(); b++) {
+        const Block& blk = blocks[b];
+        long long dx = center.x < blk.minX ? (long long)blk.minX - center.x : center.x > blk.maxX ? (long long)center.x - blk.maxX : 0;
+        long long dy = center.y < blk.minY ? (long long)blk.minY - center.y : center.y > blk.maxY ? (long long)center.y - blk.maxY : 0;
+        if (dx * dx + dy * dy > r2) continue;
+        int n = decodeBlock(b, buf);
+        for (int i = 0; i < n; i++) {
+            found += distance(center, buf[i]) <= r2;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "points.h"
+
+// Morton (Z-order) code of p: the bits of x and y interleaved, with the
+// sign bit flipped so negative coordinates sort before positive ones
+uint64_t mortonCode(Point p);
+
+// Compressed, read-only point set for scans and neighbourhood queries.
+//
+// Points are sorted by Morton code so neighbours in space end up
+// neighbours in memory, then cut into blocks of kBlockSize. Each block
+// stores its bounding box and every point as (x - minX, y - minY)
+// bit-packed at the narrowest width that fits the block, so clustered
+// data takes a few bytes per point instead of 8. Nothing is lost.
+//
+// Scans decode one block at a time into a small buffer and hand it to
+// the kernel, so the full Point array never exists in memory. Range
+// queries skip blocks whose box misses the range without decoding them.
+class PointStore {
+public:
+    static const int kBlockSize = 128;
+
+    PointStore() = default;
+    explicit PointStore(std::vector<Point> points); // sorts its own copy
+
+    size_t getSize() const { return count; }
+    size_t getBytes() const; // everything the store holds
+    double getBytesPerPoint() const { return count ? (double)getBytes() / count : 0; }
+
+    // calls fn(const Point* pts, int n) for each block in Morton order
+    template <typename Fn>
+    void forEachBlock(Fn fn) const {
+        Point buf[kBlockSize];
+        for (size_t b = 0; b < blocks.size(); b++) {
+            fn((const Point*)buf, decodeBlock(b, buf));
+        }
+    }
+
+    // sum of distance(origin, p) over all points
+    long long distanceSweep(Point origin) const;
+
+    // points with minX <= x <= maxX and minY <= y <= maxY
+    template <typename Fn>
+    void forEachInRect(int minX, int minY, int maxX, int maxY, Fn fn) const {
+        Point buf[kBlockSize];
+        for (size_t b = 0; b < blocks.size(); b++) {
+            const Block& blk = blocks[b];
+            if (blk.maxX < minX || blk.minX > maxX || blk.maxY < minY || blk.minY > maxY) continue;
+            int n = decodeBlock(b, buf);
+            for (int i = 0; i < n; i++) {
+                if (buf[i].x >= minX && buf[i].x <= maxX && buf[i].y >= minY && buf[i].y <= maxY) fn(buf[i]);
+            }
+        }
+    }
+
+    // how many points lie within squared distance r2 of center
+    size_t countWithin(Point center, int r2) const;
+
+private:
+    struct Block {
+        int minX, minY, maxX, maxY;
+        uint64_t bitOffset; // start of this block in bits
+        uint8_t widthX, widthY;
+        uint16_t count;
+    };
+
+    std::vector<Block> blocks;
+    std::vector<uint8_t> bits; // packed deltas, padded so 8-byte reads never run off the end
+    size_t count = 0;
+
+    int decodeBlock(size_t b, Point* out) const;
+};
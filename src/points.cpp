@@ -0,0 +1,35 @@
+#include "points.h"
+
+void swapReferences(int &a, int &b) { //swaps by pass by reference
+    int temp = a;
+    a = b;
+    b = temp;
+}
+
+void swapPointer(int *x, int *y) { //swaps by pass by pointer
+    int temp = *x;
+    *x = *y;
+    *y = temp;
+}
+
+int sumArray(const int arr[], int size) {
+    int sum = 0;
+    for (int i = 0; i < size; i++) {
+        sum += arr[i];
+    }
+    return sum;
+}
+
+int findMaxInArray(const int arr[], int size) {
+    int max = arr[0];
+    for (int i = 1; i < size; i++) {
+        if (arr[i] > max) {
+            max = arr[i];
+        }
+    }
+    return max;
+}
+
+int distance(Point a, Point b) {
+    return (b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+// Array and Point utilities from day 1.
+
+void swapReferences(int &a, int &b);
+void swapPointer(int *x, int *y);
+
+int sumArray(const int arr[], int size);
+int findMaxInArray(const int arr[], int size);
+
+struct Point {
+    int x;
+    int y;
+};
+
+// squared distance between a and b (no sqrt, stays in ints)
+int distance(Point a, Point b);
@@ -0,0 +1,153 @@
+#include "rcu_catalog.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "alloc_tracker.h"
+#include "epoch.h"
+#include "instrument.h"
+
+RcuCatalog::RcuCatalog() : current(new Version()) {}
+
+RcuCatalog::~RcuCatalog() {
+    const Version* v = current.load();
+    for (const Chunk* c : v->chunks) {
+        for (int i = 0; i < c->count; i++) delete c->entries[i];
+        delete c;
+    }
+    delete v;
+    for (auto& r : retired) {
+        delete r.version;
+        delete r.chunk;
+        delete r.entry;
+    }
+}
+
+RcuCatalog::Snapshot RcuCatalog::snapshot() const {
+    epoch::readLock();
+    return Snapshot(current.load(std::memory_order_seq_cst));
+}
+
+RcuCatalog::Snapshot::~Snapshot() {
+    epoch::readUnlock();
+}
+
+bool RcuCatalog::locate(const Version* v, int id, size_t& chunk, int& slot) {
+    // chunks hold increasing ids, so binary search on each chunk's first id
+    auto it = std::upper_bound(v->chunks.begin(), v->chunks.end(), id,
+                               [](int x, const Chunk* c) { return x < c->ids[0]; });
+    if (it == v->chunks.begin()) return false;
+    const Chunk* c = *--it;
+    const int* pos = std::lower_bound(c->ids, c->ids + c->count, id);
+    if (pos == c->ids + c->count || *pos != id) return false;
+    chunk = it - v->chunks.begin();
+    slot = (int)(pos - c->ids);
+    return true;
+}
+
+const CatalogEntry* RcuCatalog::Snapshot::find(int id) const {
+    size_t chunk;
+    int slot;
+    if (!locate(v, id, chunk, slot)) return nullptr;
+    return v->chunks[chunk]->entries[slot];
+}
+
+void RcuCatalog::publish(Version* next, const Chunk* chunk, const CatalogEntry* entry) {
+    const Version* old = current.load(std::memory_order_relaxed);
+    next->number = old->number + 1;
+    current.store(next, std::memory_order_seq_cst);
+    retired.push_back({epoch::retireEpoch(), old, chunk, entry});
+    INSTR_COUNT("rcu_catalog.publish");
+    reclaimLocked();
+}
+
+void RcuCatalog::add(const CatalogEntry& e) {
+    ALLOC_SCOPE("rcu_catalog");
+    std::lock_guard<std::mutex> lock(writeMutex);
+    const Version* old = current.load(std::memory_order_relaxed);
+    if (!old->chunks.empty()) {
+        const Chunk* tail = old->chunks.back();
+        if (e.id <= tail->ids[tail->count - 1]) {
+            throw std::invalid_argument("RcuCatalog: ids must be added in increasing order");
+        }
+    }
+
+    Version* next = new Version(*old);
+    next->liveCount++;
+    const Chunk* replaced = nullptr;
+    Chunk* tail;
+    if (next->chunks.empty() || next->chunks.back()->count == kChunkSize) {
+        tail = new Chunk();
+        next->chunks.push_back(tail);
+    } else {
+        replaced = next->chunks.back();
+        tail = new Chunk(*replaced); // copies entry pointers, not entries
+        next->chunks.back() = tail;
+    }
+    tail->ids[tail->count] = e.id;
+    tail->entries[tail->count] = new CatalogEntry(e);
+    tail->count++;
+    publish(next, replaced, nullptr);
+}
+
+bool RcuCatalog::replace(int id, bool remove, const std::string& title, const std::string& author) {
+    ALLOC_SCOPE("rcu_catalog");
+    std::lock_guard<std::mutex> lock(writeMutex);
+    const Version* old = current.load(std::memory_order_relaxed);
+    size_t chunk;
+    int slot;
+    if (!locate(old, id, chunk, slot) || !old->chunks[chunk]->entries[slot]) {
+        return false;
+    }
+    Version* next = new Version(*old);
+    const Chunk* replaced = old->chunks[chunk];
+    Chunk* copy = new Chunk(*replaced);
+    const CatalogEntry* previous = copy->entries[slot];
+    const CatalogEntry* with = remove ? nullptr : new CatalogEntry{id, title, author, previous->issue};
+    copy->entries[slot] = with;
+    next->chunks[chunk] = copy;
+    if (!with) next->liveCount--;
+    publish(next, replaced, previous);
+    return true;
+}
+
+void RcuCatalog::addBook(const Book& b) {
+    add({b.getId(), b.getTitle(), b.getAuthor(), -1});
+}
+
+void RcuCatalog::addMagazine(const Magazine& m) {
+    add({m.getId(), m.getTitle(), m.getAuthor(), m.getIssueNumber()});
+}
+
+bool RcuCatalog::updateBook(int id, const std::string& title, const std::string& author) {
+    return replace(id, false, title, author);
+}
+
+bool RcuCatalog::removeBook(int id) {
+    return replace(id, true, "", "");
+}
+
+size_t RcuCatalog::reclaim() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return reclaimLocked();
+}
+
+size_t RcuCatalog::reclaimLocked() {
+    uint64_t oldest = epoch::oldestActiveEpoch();
+    size_t freed = 0;
+    auto keep = std::remove_if(retired.begin(), retired.end(), [&](const Retired& r) {
+        if (r.epoch >= oldest) return false;
+        delete r.version;
+        delete r.chunk;
+        delete r.entry;
+        freed++;
+        return true;
+    });
+    retired.erase(keep, retired.end());
+    return freed;
+}
+
+size_t RcuCatalog::getRetiredCount() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return retired.size();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "generator.h"
+#include "library.h"
+
+// Catalog for read-heavy traffic with a writer that keeps adding Books.
+//
+// Each published version is immutable: a spine of pointers to chunks of
+// kChunkSize entry pointers. A write copies the spine and the one chunk
+// it touches, shares everything else with the previous version, and
+// swaps the new version in with one atomic store. Readers take a
+// Snapshot, which pins the version current at that moment through the
+// epoch scheme in epoch.h; they never block and never see a half-applied
+// write. Replaced versions, chunks and entries are freed by the writer
+// once every reader that could see them has moved on.
+//
+// Entries must be added in increasing id order, which is the order Book
+// hands ids out in. Writers are serialised with a mutex.
+class RcuCatalog {
+    static const int kChunkSize = 256;
+
+    struct Chunk {
+        int count = 0;
+        int ids[kChunkSize];
+        const CatalogEntry* entries[kChunkSize]; // nullptr once removed
+    };
+
+    struct Version {
+        uint64_t number = 0;
+        size_t liveCount = 0;
+        std::vector<const Chunk*> chunks;
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        const Version* version;
+        const Chunk* chunk;
+        const CatalogEntry* entry;
+    };
+
+    std::atomic<const Version*> current;
+    std::mutex writeMutex;
+    std::vector<Retired> retired; // guarded by writeMutex
+
+    // finds id in v: chunk index and slot, false if absent
+    static bool locate(const Version* v, int id, size_t& chunk, int& slot);
+
+    // publishes next and retires old, chunk and entry (any may be null)
+    void publish(Version* next, const Chunk* chunk, const CatalogEntry* entry);
+    void add(const CatalogEntry& e);
+    // updates title/author of id, or removes it when remove is set
+    bool replace(int id, bool remove, const std::string& title, const std::string& author);
+    size_t reclaimLocked();
+
+public:
+    // a consistent, read-only view; keep it short-lived, it delays the
+    // reclamation of everything written after it was taken. It holds this
+    // thread's epoch read lock, so it cannot be moved and must be
+    // destroyed on the thread that took it.
+    class Snapshot {
+        const Version* v;
+        explicit Snapshot(const Version* version) : v(version) {}
+        friend class RcuCatalog;
+    public:
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        ~Snapshot();
+
+        // pointer stays valid until the snapshot is destroyed
+        const CatalogEntry* find(int id) const;
+        size_t getSize() const { return v->liveCount; }
+        uint64_t getVersion() const { return v->number; }
+
+        template <typename Fn>
+        void forEach(Fn fn) const {
+            for (const Chunk* c : v->chunks) {
+                for (int i = 0; i < c->count; i++) {
+                    if (c->entries[i]) fn(*c->entries[i]);
+                }
+            }
+        }
+
+        // the same entries as forEach, pulled one at a time; the snapshot
+        // must outlive the generator
+        Generator<CatalogEntry> entries() const {
+            for (const Chunk* c : v->chunks) {
+                for (int i = 0; i < c->count; i++) {
+                    if (c->entries[i]) co_yield *c->entries[i];
+                }
+            }
+        }
+    };
+
+    RcuCatalog();
+    ~RcuCatalog(); // no snapshots may be alive
+    RcuCatalog(const RcuCatalog&) = delete;
+    RcuCatalog& operator=(const RcuCatalog&) = delete;
+
+    Snapshot snapshot() const;
+
+    // throws std::invalid_argument if the id is not above every added id
+    void addBook(const Book& b);
+    void addMagazine(const Magazine& m);
+    bool updateBook(int id, const std::string& title, const std::string& author); // false if unknown
+    bool removeBook(int id); // false if unknown
+
+    // frees whatever no reader can see any more; writes call this too
+    size_t reclaim();
+    size_t getRetiredCount();
+};
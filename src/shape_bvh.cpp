@@ -0,0 +1,197 @@
+#include "shape_bvh.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "alloc_tracker.h"
+#include "instrument.h"
+
+namespace {
+
+double centre(const Aabb& b, int axis) {
+    return axis == 0 ? b.minX + b.maxX : b.minY + b.maxY; // doubled, only compared
+}
+
+const Aabb kEmpty = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                     -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+
+} // namespace
+
+ShapeBvh::ShapeBvh(std::vector<Shape*> scene) : scene(std::move(scene)) {
+    build();
+}
+
+void ShapeBvh::fitNode(Node& node) const {
+    node.box = kEmpty;
+    for (int i = node.leftFirst; i < node.leftFirst + node.count; i++) node.box.grow(items[i].box);
+}
+
+void ShapeBvh::build() {
+    INSTR_SCOPE("bvh.build");
+    ALLOC_SCOPE("bvh");
+    items.resize(scene.size());
+    for (size_t i = 0; i < scene.size(); i++) items[i] = {scene[i]->bounds(), (int)i};
+    nodes.clear();
+    if (scene.empty()) return;
+    nodes.reserve(2 * scene.size());
+    nodes.push_back({kEmpty, 0, (int)scene.size()});
+    fitNode(nodes[0]);
+
+    // work list of (node, depth); each split appends the two children
+    std::vector<std::pair<int, int>> work = {{0, 0}};
+    while (!work.empty()) {
+        auto [n, depth] = work.back();
+        work.pop_back();
+        int first = nodes[n].leftFirst, count = nodes[n].count;
+        Aabb childBox[2];
+        int leftCount = partition(nodes[n].box, first, count, depth, childBox);
+        if (leftCount == 0) continue;
+        int left = (int)nodes.size();
+        nodes.push_back({childBox[0], first, leftCount});
+        nodes.push_back({childBox[1], first + leftCount, count - leftCount});
+        nodes[n].leftFirst = left;
+        nodes[n].count = 0;
+        work.push_back({left, depth + 1});
+        work.push_back({left + 1, depth + 1});
+    }
+}
+
+int ShapeBvh::partition(const Aabb& box, int first, int count, int depth, Aabb childBox[2]) {
+    if (count <= 1) return 0;
+    double area = box.halfPerimeter();
+    Item* begin = items.data() + first;
+    Item* end = begin + count;
+
+    // centre bounds on both axes, then both axes' bins, one pass each
+    double lo[2] = {centre(begin->box, 0), centre(begin->box, 1)};
+    double hi[2] = {lo[0], lo[1]};
+    for (Item* it = begin; it != end; it++) {
+        double cx = centre(it->box, 0), cy = centre(it->box, 1);
+        lo[0] = std::min(lo[0], cx);
+        hi[0] = std::max(hi[0], cx);
+        lo[1] = std::min(lo[1], cy);
+        hi[1] = std::max(hi[1], cy);
+    }
+
+    // binned SAH: cost of a split is count-weighted half-perimeter of each
+    // side; leaving the node as a leaf costs one test per item
+    int bestAxis = -1, bestBin = 0;
+    double bestCost = std::numeric_limits<double>::infinity();
+    Aabb binBox[2][kBins];
+    if (depth < kMaxSahDepth && (hi[0] > lo[0] || hi[1] > lo[1])) {
+        double scale[2] = {hi[0] > lo[0] ? kBins / (hi[0] - lo[0]) : 0, hi[1] > lo[1] ? kBins / (hi[1] - lo[1]) : 0};
+        int binCount[2][kBins] = {};
+        std::fill(&binBox[0][0], &binBox[0][0] + 2 * kBins, kEmpty);
+        for (Item* it = begin; it != end; it++) {
+            for (int axis = 0; axis < 2; axis++) {
+                int b = std::min(kBins - 1, (int)((centre(it->box, axis) - lo[axis]) * scale[axis]));
+                binBox[axis][b].grow(it->box);
+                binCount[axis][b]++;
+            }
+        }
+        for (int axis = 0; axis < 2; axis++) {
+            if (hi[axis] <= lo[axis]) continue;
+            // sweep from the right, then from the left, to cost each plane
+            double rightArea[kBins];
+            int rightCount[kBins];
+            Aabb acc = kEmpty;
+            int accCount = 0;
+            for (int b = kBins - 1; b > 0; b--) {
+                acc.grow(binBox[axis][b]);
+                accCount += binCount[axis][b];
+                rightArea[b] = accCount ? acc.halfPerimeter() : 0;
+                rightCount[b] = accCount;
+            }
+            acc = kEmpty;
+            accCount = 0;
+            for (int b = 0; b < kBins - 1; b++) {
+                acc.grow(binBox[axis][b]);
+                accCount += binCount[axis][b];
+                if (accCount == 0 || rightCount[b + 1] == 0) continue;
+                double cost = acc.halfPerimeter() * accCount + rightArea[b + 1] * rightCount[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = b;
+                }
+            }
+        }
+    }
+
+    // splitting costs a node visit on top of the children's tests
+    double leafCost = area * count;
+    bool split = bestAxis >= 0 && (count > kMaxLeafSize || area + bestCost < leafCost);
+    if (split) {
+        double scale = kBins / (hi[bestAxis] - lo[bestAxis]);
+        Item* mid = std::partition(begin, end, [&](const Item& it) {
+            return std::min(kBins - 1, (int)((centre(it.box, bestAxis) - lo[bestAxis]) * scale)) <= bestBin;
+        });
+        // the child boxes are unions of the bins on each side
+        childBox[0] = childBox[1] = kEmpty;
+        for (int b = 0; b < kBins; b++) childBox[b <= bestBin ? 0 : 1].grow(binBox[bestAxis][b]);
+        return (int)(mid - begin);
+    }
+    if (count <= kMaxLeafSize) return 0;
+
+    // past the depth limit, or every centre coincides: object median
+    int axis = hi[0] - lo[0] >= hi[1] - lo[1] ? 0 : 1;
+    Item* mid = begin + count / 2;
+    std::nth_element(begin, mid, end, [axis](const Item& a, const Item& b) {
+        return centre(a.box, axis) < centre(b.box, axis);
+    });
+    childBox[0] = childBox[1] = kEmpty;
+    for (Item* it = begin; it != end; it++) childBox[it < mid ? 0 : 1].grow(it->box);
+    return count / 2;
+}
+
+void ShapeBvh::refit() {
+    INSTR_SCOPE("bvh.refit");
+    for (Item& item : items) item.box = scene[item.index]->bounds();
+    // children come after their parent, so walking backwards is bottom-up
+    for (size_t n = nodes.size(); n-- > 0;) {
+        Node& node = nodes[n];
+        if (node.count > 0) {
+            fitNode(node);
+        } else {
+            node.box = nodes[node.leftFirst].box;
+            node.box.grow(nodes[node.leftFirst + 1].box);
+        }
+    }
+}
+
+double ShapeBvh::getSahCost() const {
+    if (nodes.empty()) return 0;
+    double total = 0;
+    for (const Node& node : nodes) {
+        total += node.box.halfPerimeter() * (node.count > 0 ? node.count : 1);
+    }
+    double root = nodes[0].box.halfPerimeter();
+    return root > 0 ? total / root : total;
+}
+
+size_t ShapeBvh::drawVisible(const Aabb& viewport) {
+    INSTR_SCOPE("bvh.draw_visible");
+    visible.clear();
+    forEachItemInRect(viewport, [&](const Item& item) { visible.push_back(item.index); });
+    std::sort(visible.begin(), visible.end());
+    for (int index : visible) scene[index]->draw();
+    INSTR_COUNT_N("bvh.drawn", visible.size());
+    return visible.size();
+}
+
+Shape* ShapeBvh::pickPoint(double x, double y) const {
+    Aabb probe = {x, y, x, y};
+    int best = -1;
+    forEachItemInRect(probe, [&](const Item& item) {
+        if (item.index > best && scene[item.index]->contains(x, y)) best = item.index;
+    });
+    return best >= 0 ? scene[best] : nullptr;
+}
+
+void ShapeBvh::pickRect(const Aabb& r, std::vector<Shape*>& out) const {
+    std::vector<int> hits;
+    forEachItemInRect(r, [&](const Item& item) { hits.push_back(item.index); });
+    std::sort(hits.begin(), hits.end());
+    for (int index : hits) out.push_back(scene[index]);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "shapes.h"
+
+// Bounding-volume hierarchy over a scene of shapes, built with binned SAH
+// (surface area heuristic, using half-perimeter in 2D).
+//
+// The BVH does not own the shapes; the scene must outlive it. Moving
+// shapes is handled in two ways. refit() re-reads every bounds() and
+// re-fits the node boxes without changing the tree, which is cheap but
+// lets the tree quality drift. build() starts over. getSahCost() reports
+// how far a refit tree has drifted, so callers can rebuild when the
+// cost has grown past what they tolerate.
+class ShapeBvh {
+public:
+    static const int kMaxLeafSize = 4;
+
+    ShapeBvh() = default;
+    explicit ShapeBvh(std::vector<Shape*> scene);
+
+    void build();
+    void refit();
+
+    size_t getSize() const { return scene.size(); }
+    size_t getNodeCount() const { return nodes.size(); }
+    double getSahCost() const; // expected node visits + shape tests for a random query, relative to the root
+
+    // calls fn(Shape*) for every shape whose bounds overlap r, in tree order
+    template <typename Fn>
+    void forEachInRect(const Aabb& r, Fn fn) const {
+        forEachItemInRect(r, [&](const Item& item) { fn(scene[item.index]); });
+    }
+
+    // draws the shapes overlapping viewport in scene order, so overlaps
+    // paint the same way as drawing everything; returns how many were drawn
+    size_t drawVisible(const Aabb& viewport);
+
+    // topmost (last in scene order) shape containing the point, or nullptr
+    Shape* pickPoint(double x, double y) const;
+
+    // appends the shapes whose bounds overlap r to out, in scene order
+    void pickRect(const Aabb& r, std::vector<Shape*>& out) const;
+
+private:
+    // SAH splits stop at kMaxSahDepth and fall back to median splits,
+    // which halve the range each level, so traversal fits in kStackSize
+    static const int kBins = 12;
+    static const int kMaxSahDepth = 64;
+    static const int kStackSize = 128;
+
+    struct Node {
+        Aabb box;
+        int leftFirst; // first item for a leaf, left child for an inner node (right is +1)
+        int count;     // items in a leaf, 0 for an inner node
+    };
+
+    struct Item {
+        Aabb box;
+        int index; // into scene
+    };
+
+    std::vector<Shape*> scene;
+    std::vector<Item> items; // leaf order
+    std::vector<Node> nodes; // children always come after their parent
+    std::vector<int> visible; // drawVisible scratch, kept to avoid per-frame allocation
+
+    void fitNode(Node& node) const;
+    // reorders a node's items into two halves and fills their boxes;
+    // returns the size of the left half, or 0 to keep the node a leaf
+    int partition(const Aabb& box, int first, int count, int depth, Aabb childBox[2]);
+
+    template <typename Fn>
+    void forEachItemInRect(const Aabb& r, Fn fn) const {
+        if (nodes.empty()) return;
+        int stack[kStackSize];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (!node.box.overlaps(r)) continue;
+            if (node.count > 0) {
+                for (int i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+                    if (items[i].box.overlaps(r)) fn(items[i]);
+                }
+            } else {
+                stack[top++] = node.leftFirst + 1;
+                stack[top++] = node.leftFirst;
+            }
+        }
+    }
+};
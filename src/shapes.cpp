@@ -0,0 +1,49 @@
+#include "shapes.h"
+
+#include <iostream>
+
+#include "instrument.h"
+
+double Circle::area() const {
+    INSTR_COUNT("shape.area.circle");
+    return 3.14159 * radius * radius;
+}
+
+Aabb Circle::bounds() const {
+    return {getX() - radius, getY() - radius, getX() + radius, getY() + radius};
+}
+
+bool Circle::contains(double px, double py) const {
+    double dx = px - getX(), dy = py - getY();
+    return dx * dx + dy * dy <= radius * radius;
+}
+
+void Circle::draw() {
+    std::cout << "Drawing Circle with radius: " << radius << std::endl;
+}
+
+double Rectangle::area() const {
+    INSTR_COUNT("shape.area.rectangle");
+    return width * height;
+}
+
+Aabb Rectangle::bounds() const {
+    return {getX() - width / 2, getY() - height / 2, getX() + width / 2, getY() + height / 2};
+}
+
+void Rectangle::draw() {
+    std::cout << "Drawing Rectangle with width: " << width << " and height: " << height << std::endl;
+}
+
+double Square::area() const {
+    INSTR_COUNT("shape.area.square");
+    return side * side;
+}
+
+Aabb Square::bounds() const {
+    return {getX() - side / 2, getY() - side / 2, getX() + side / 2, getY() + side / 2};
+}
+
+void Square::draw() {
+    std::cout << "Drawing Square with side: " << side << std::endl;
+}
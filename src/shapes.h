@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+
+// Axis-aligned bounding box in scene coordinates.
+struct Aabb {
+    double minX, minY, maxX, maxY;
+
+    bool overlaps(const Aabb& o) const {
+        return minX <= o.maxX && o.minX <= maxX && minY <= o.maxY && o.minY <= maxY;
+    }
+    bool contains(double x, double y) const {
+        return x >= minX && x <= maxX && y >= minY && y <= maxY;
+    }
+    void grow(const Aabb& o) {
+        minX = std::min(minX, o.minX);
+        minY = std::min(minY, o.minY);
+        maxX = std::max(maxX, o.maxX);
+        maxY = std::max(maxY, o.maxY);
+    }
+    // 2D analogue of surface area, the cost weight in SAH
+    double halfPerimeter() const { return (maxX - minX) + (maxY - minY); }
+};
+
+// Shape hierarchy from days 2 and 4. Every shape sits at a position
+// (its centre) so a scene can be culled and hit-tested.
+struct Shape {
+    private: double x = 0, y = 0;
+    public:
+    Shape() = default;
+    Shape(double x, double y) : x(x), y(y) {}
+    double getX() const { return x; }
+    double getY() const { return y; }
+    void setPosition(double nx, double ny) { x = nx; y = ny; }
+
+    virtual void draw() = 0; //pure virtual function
+    virtual double area() const = 0; //pure virtual function
+    virtual Aabb bounds() const = 0;
+    // exact hit test; bounds() only has to enclose the shape
+    virtual bool contains(double px, double py) const { return bounds().contains(px, py); }
+    virtual ~Shape() {} //virtual destructor, needed for base classes with virtual functions
+};
+
+struct Circle : public Shape {
+    private: double radius;
+    public:
+    explicit Circle(double r) : radius(r) {}
+    Circle(double r, double x, double y) : Shape(x, y), radius(r) {}
+    double getRadius() const { return radius; }
+    double area() const override;
+    Aabb bounds() const override;
+    bool contains(double px, double py) const override;
+    void draw() override;
+};
+
+struct Rectangle : public Shape {
+    private: double width, height;
+    public:
+    Rectangle(double w, double h) : width(w), height(h) {}
+    Rectangle(double w, double h, double x, double y) : Shape(x, y), width(w), height(h) {}
+    double getWidth() const { return width; }
+    double getHeight() const { return height; }
+    double area() const override;
+    Aabb bounds() const override;
+    void draw() override;
+};
+
+struct Square : public Shape {
+    private: double side;
+    public:
+    explicit Square(double s) : side(s) {}
+    Square(double s, double x, double y) : Shape(x, y), side(s) {}
+    double getSide() const { return side; }
+    double area() const override;
+    Aabb bounds() const override;
+    void draw() override;
+};
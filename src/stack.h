@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdexcept>
+#include <vector>
+
+#include "alloc_tracker.h"
+#include "generator.h"
+#include "instrument.h"
+
+// Generic Stack<T> from the day 5 quiz.
+template <typename T>
+class Stack {
+  private:
+      std::vector<T> elements; // Use a vector to store stack elements
+  public:
+      void push(const T& element) {
+          INSTR_COUNT("stack.push");
+          ALLOC_SCOPE("stack");
+          elements.push_back(element); // Add element to the top of the stack
+      }
+
+      void pop() {
+          if (!elements.empty()) {
+              elements.pop_back(); // Remove the top element of the stack
+          } else {
+              throw std::runtime_error("Stack is empty");
+          }
+      }
+
+      const T& top() const {
+          if (!elements.empty()) {
+              return elements.back(); // Return the top element of the stack
+          } else {
+              throw std::runtime_error("Stack is empty");
+          }
+      }
+
+      // elements from the top down, produced one at a time; the stack
+      // must outlive the generator and stay unchanged while it runs
+      Generator<T> walk() const {
+          for (size_t i = elements.size(); i-- > 0;) co_yield elements[i];
+      }
+
+      bool empty() const { return elements.empty(); }
+      size_t size() const { return elements.size(); }
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "generator.h"
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    // resumes whoever awaited the task, by tail call, so long chains of
+    // tasks finishing synchronously do not grow the stack
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+            auto next = h.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { error = std::current_exception(); }
+    void rethrowIfFailed() const {
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+    Task<T> get_return_object();
+    void return_value(T v) { value.emplace(std::move(v)); }
+    T result() {
+        rethrowIfFailed();
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+    void result() { rethrowIfFailed(); }
+};
+
+} // namespace detail
+
+// Asynchronous unit of work written as a coroutine that may co_await
+// other Tasks (or any awaitable) and co_returns a T.
+//
+// A Task is lazy: it starts when awaited, and when it finishes it resumes
+// its awaiter directly. There is no scheduler; whoever completes the
+// awaited operation resumes the chain on its own thread. syncWait()
+// drives a Task from ordinary code and blocks until it is done.
+// Exceptions propagate to the awaiter.
+template <typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task(Task&& other) noexcept : h(std::exchange(other.h, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (h) h.destroy();
+            h = std::exchange(other.h, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (h) h.destroy();
+    }
+
+    // a Task may be awaited once
+    auto operator co_await() && noexcept { return Awaiter{h}; }
+    auto operator co_await() & noexcept { return Awaiter{h}; }
+
+private:
+    Handle h;
+
+    explicit Task(Handle handle) : h(handle) {}
+    friend struct detail::TaskPromise<T>;
+
+    struct Awaiter {
+        Handle h;
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            h.promise().continuation = awaiting;
+            return h; // start the task
+        }
+        T await_resume() { return h.promise().result(); }
+    };
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// fire-and-forget coroutine that frees itself when it finishes
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+struct SyncWaitState {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    std::exception_ptr error;
+
+    // notify under the lock: the waiter cannot return and free the state
+    // until the signalling thread has let go of it
+    void finish() {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        cv.notify_one();
+    }
+};
+
+template <typename T>
+Detached driveTask(Task<T>& task, std::optional<T>& out, SyncWaitState& state) {
+    try {
+        out.emplace(co_await task);
+    } catch (...) {
+        state.error = std::current_exception();
+    }
+    state.finish();
+}
+
+inline Detached driveTask(Task<void>& task, SyncWaitState& state) {
+    try {
+        co_await task;
+    } catch (...) {
+        state.error = std::current_exception();
+    }
+    state.finish();
+}
+
+} // namespace detail
+
+// runs task to completion and returns its result (or rethrows)
+template <typename T>
+T syncWait(Task<T> task) {
+    detail::SyncWaitState state;
+    std::optional<T> out;
+    detail::driveTask(task, out, state);
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.cv.wait(lock, [&] { return state.done; });
+    if (state.error) std::rethrow_exception(state.error);
+    return std::move(*out);
+}
+
+inline void syncWait(Task<void> task) {
+    detail::SyncWaitState state;
+    detail::driveTask(task, state);
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.cv.wait(lock, [&] { return state.done; });
+    if (state.error) std::rethrow_exception(state.error);
+}
+
+namespace lazy {
+
+// async sink: awaits fn(v) for each value in order, so a slow consumer
+// holds back the producer instead of letting values pile up
+template <typename T, typename Fn>
+Task<void> forEachAsync(Generator<T> src, Fn fn) {
+    for (const auto& v : src) co_await fn(v);
+}
+
+} // namespace lazy
@@ -0,0 +1,113 @@
+#include "thread_pool.h"
+
+#include <utility>
+
+namespace {
+// pool whose task the current thread is running, if any
+thread_local ThreadPool* insidePool = nullptr;
+
+// sets insidePool for the current scope, restoring it even if a task throws
+class InsidePool {
+    ThreadPool* saved;
+public:
+    explicit InsidePool(ThreadPool* pool) : saved(insidePool) { insidePool = pool; }
+    ~InsidePool() { insidePool = saved; }
+    InsidePool(const InsidePool&) = delete;
+    InsidePool& operator=(const InsidePool&) = delete;
+};
+}
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+        if (threads <= 0) threads = 1;
+    }
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : workers) {
+        t.join();
+    }
+}
+
+void ThreadPool::drain(const std::function<void(int)>& fn, int tasks) {
+    InsidePool scope(this);
+    for (;;) {
+        int t = nextTask.fetch_add(1, std::memory_order_relaxed);
+        if (t >= tasks) break;
+        try {
+            fn(t);
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) error = std::current_exception();
+            }
+            // the job has failed: hand out no more of its tasks
+            nextTask.store(tasks, std::memory_order_relaxed);
+        }
+    }
+}
+
+void ThreadPool::workerLoop() {
+    unsigned seen = 0;
+    for (;;) {
+        const std::function<void(int)>* fn;
+        int tasks;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            if (!job) continue; // woke after that job already completed
+            fn = job;
+            tasks = jobTasks;
+            busyWorkers++;
+        }
+        drain(*fn, tasks);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busyWorkers--;
+        }
+        finished.notify_one();
+    }
+}
+
+void ThreadPool::run(int tasks, const std::function<void(int)>& fn) {
+    if (tasks <= 0) return;
+    if (workers.empty() || tasks == 1 || insidePool == this) {
+        for (int t = 0; t < tasks; t++) fn(t);
+        return;
+    }
+
+    std::lock_guard<std::mutex> serial(runMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobTasks = tasks;
+        nextTask.store(0, std::memory_order_relaxed);
+        generation++;
+    }
+    wake.notify_all();
+    drain(fn, tasks);
+
+    // workers that picked up this job must finish before fn goes away
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&] { return busyWorkers == 0; });
+    job = nullptr;
+    std::exception_ptr failed = std::exchange(error, nullptr);
+    lock.unlock();
+    if (failed) std::rethrow_exception(failed);
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads for fork/join loops. run() hands out
+// task indices 0..tasks-1 to the workers and the calling thread, and
+// returns once all of them finished. A task that calls run() on the pool
+// it runs in gets its sub-tasks executed inline instead of deadlocking.
+// If a task throws, no further tasks start, and run() rethrows the first
+// exception once the tasks already running have finished.
+class ThreadPool {
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    std::mutex runMutex; // one job at a time
+
+    // current job, guarded by mutex except for the atomics
+    const std::function<void(int)>* job = nullptr;
+    int jobTasks = 0;
+    std::atomic<int> nextTask{0};
+    int busyWorkers = 0;
+    unsigned generation = 0;
+    bool stopping = false;
+    std::exception_ptr error; // first exception thrown by the current job
+
+    void workerLoop();
+    void drain(const std::function<void(int)>& fn, int tasks);
+
+public:
+    // threads = total parallelism including the caller; 0 = one per core
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // workers plus the calling thread
+    int getThreadCount() const { return (int)workers.size() + 1; }
+
+    void run(int tasks, const std::function<void(int)>& fn);
+
+    // process-wide pool sized to the machine, created on first use
+    static ThreadPool& shared();
+};
@@ -0,0 +1,166 @@
+#include "vector.h"
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+#include "alloc_tracker.h"
+#include "instrument.h"
+
+Vector::Vector() {
+    ALLOC_SCOPE("vector");
+    data = new int[1];
+    size = 0;
+    capacity = 1;
+}
+
+Vector::Vector(int n) {
+    ALLOC_SCOPE("vector");
+    capacity = n > 0 ? n : 1; // capacity 0 would never grow when doubled
+    data = new int[capacity];
+    size = 0;
+}
+
+Vector::Vector(const Vector &other) {
+    ALLOC_SCOPE("vector");
+    size = other.size;
+    capacity = other.capacity;
+    data = new int[capacity];
+    for (int i = 0; i < size; i++) {
+        data[i] = other.data[i];
+    }
+}
+
+Vector::Vector(Vector &&other) noexcept
+    : data(other.data), size(other.size), capacity(other.capacity) {
+    other.data = nullptr;
+    other.size = 0;
+    other.capacity = 0;
+}
+
+Vector& Vector::operator=(const Vector &other) {
+    if (this != &other) { // self-assignment check
+        ALLOC_SCOPE("vector");
+        delete[] data; // free existing resource
+        size = other.size;
+        capacity = other.capacity;
+        data = new int[capacity];
+        for (int i = 0; i < size; i++) {
+            data[i] = other.data[i];
+        }
+    }
+    return *this;
+}
+
+Vector& Vector::operator=(Vector &&other) noexcept {
+    if (this != &other) {
+        delete[] data;
+        data = other.data;
+        size = other.size;
+        capacity = other.capacity;
+        other.data = nullptr;
+        other.size = 0;
+        other.capacity = 0;
+    }
+    return *this;
+}
+
+Vector::~Vector() {
+    delete[] data;
+}
+
+void Vector::reallocate(int newCapacity) {
+    INSTR_SCOPE("vector.grow");
+    ALLOC_SCOPE("vector");
+    int* newData = new int[newCapacity];
+    std::copy(data, data + size, newData);
+    delete[] data;
+    data = newData;
+    capacity = newCapacity;
+}
+
+void Vector::growFor(int needed) {
+    if (needed > capacity) {
+        // a moved-from Vector has capacity 0 so start again at 1; past
+        // INT_MAX / 2 doubling would overflow, so stop at INT_MAX
+        int doubled = capacity <= 0 ? 1 : capacity > INT_MAX / 2 ? INT_MAX : capacity * 2;
+        reallocate(needed > doubled ? needed : doubled);
+    }
+}
+
+void Vector::push_back(int value) {
+    INSTR_COUNT("vector.push_back");
+    if (size == capacity) {
+        growFor(size + 1);
+    }
+    data[size++] = value;
+}
+
+void Vector::reserve(int n) {
+    if (n > capacity) {
+        reallocate(n);
+    }
+}
+
+void Vector::append(std::span<const int> values) {
+    INSTR_COUNT("vector.append");
+    int n = (int)values.size();
+    const int* src = values.data();
+    if (src >= data && src < data + size) {
+        // appending part of ourselves, find it again after growing
+        long offset = src - data;
+        growFor(size + n);
+        src = data + offset;
+    } else {
+        growFor(size + n);
+    }
+    std::copy(src, src + n, data + size);
+    size += n;
+}
+
+void Vector::insert(int pos, std::span<const int> values) {
+    INSTR_COUNT("vector.insert");
+    if (pos < 0 || pos > size) {
+        throw std::out_of_range("Vector::insert position out of range");
+    }
+    // values pointing into this Vector would be freed by a reallocation or
+    // clobbered by the shift below, so copy them aside first
+    if (values.data() >= data && values.data() < data + size) {
+        Vector tmp((int)values.size());
+        tmp.append(values);
+        insert(pos, std::span<const int>(tmp.begin(), tmp.end()));
+        return;
+    }
+    int n = (int)values.size();
+    growFor(size + n);
+    std::copy_backward(data + pos, data + size, data + size + n);
+    std::copy(values.begin(), values.end(), data + pos);
+    size += n;
+}
+
+void Vector::resize(int n, int fill) {
+    int old = size;
+    resize_uninitialized(n);
+    if (n > old) {
+        std::fill(data + old, data + n, fill);
+    }
+}
+
+void Vector::resize_uninitialized(int n) {
+    if (n < 0) n = 0;
+    growFor(n); // geometric, so a loop of resize(getSize() + k) stays linear
+    size = n;
+}
+
+void Vector::pop_back() {
+    if (size > 0) {
+        size--;
+    }
+}
+
+void Vector::print(std::ostream &out) const {
+    for (int i = 0; i < size; i++) {
+        out << data[i] << " ";
+    }
+    out << std::endl;
+}
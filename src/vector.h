@@ -0,0 +1,47 @@
+#pragma once
+
+#include <iostream>
+#include <span>
+
+// Growable int array from day 3 (Rule of Five). Iterators are plain
+// pointers, so <algorithm> works on begin()/end() directly.
+class Vector {
+    int* data;
+    int size;
+    int capacity;
+
+    void reallocate(int newCapacity); // keeps the first size elements
+    void growFor(int needed); // at least doubles, like push_back
+
+public:
+    Vector(); // default constructor
+    explicit Vector(int n); // reserves room for n elements
+    Vector(const Vector &other); // copy constructor
+    Vector(Vector &&other) noexcept; // move constructor
+    Vector& operator=(const Vector &other); // copy assignment operator
+    Vector& operator=(Vector &&other) noexcept; // move assignment operator
+    ~Vector();
+
+    void push_back(int value);
+    void pop_back();
+
+    // bulk versions: at most one reallocation per call
+    void reserve(int n);
+    void append(std::span<const int> values);
+    void insert(int pos, std::span<const int> values); // before index pos
+    void resize(int n, int fill = 0);
+    void resize_uninitialized(int n); // new elements are left unset
+    void clear() { size = 0; }
+
+    int* begin() { return data; }
+    int* end() { return data + size; }
+    const int* begin() const { return data; }
+    const int* end() const { return data + size; }
+
+    int get(int i) const { return data[i]; }
+    void set(int i, int value) { data[i] = value; }
+    int getSize() const { return size; }
+    int getCapacity() const { return capacity; }
+
+    void print(std::ostream &out = std::cout) const;
+};
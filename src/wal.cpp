@@ -0,0 +1,178 @@
+#include "wal.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include "instrument.h"
+#include "io_util.h"
+
+namespace {
+
+uint32_t crcTable[256];
+
+bool initCrcTable() {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = c & 1 ? (c >> 1) ^ 0x82f63b78u : c >> 1;
+        }
+        crcTable[i] = c;
+    }
+    return true;
+}
+
+const size_t kHeaderBytes = 16;
+
+} // namespace
+
+uint32_t crc32c(const void* data, size_t len, uint32_t crc) {
+    static bool ready = initCrcTable();
+    (void)ready;
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = crcTable[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& p, uint64_t next, Options o)
+    : path(p), opt(o), nextLsn(next), durableLsn(next - 1) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) throw io::ioError("cannot open log", path);
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    try {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!pending.empty() && !failed) {
+            flushLocked(lock);
+        }
+    } catch (const std::exception&) {
+        // nobody is waiting for these records any more
+    }
+    ::close(fd);
+}
+
+uint64_t WriteAheadLog::replay(const std::string& path,
+                               const std::function<void(uint64_t, const std::string&)>& fn) {
+    int in = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (in < 0) {
+        if (errno == ENOENT) return 0;
+        throw io::ioError("cannot open log", path);
+    }
+    std::string data;
+    if (!io::readAll(in, data)) {
+        ::close(in);
+        throw io::ioError("cannot read log", path);
+    }
+
+    uint64_t lastLsn = 0;
+    size_t pos = 0;
+    while (pos + kHeaderBytes <= data.size()) {
+        uint32_t len, crc;
+        uint64_t lsn;
+        std::memcpy(&len, data.data() + pos, 4);
+        std::memcpy(&crc, data.data() + pos + 4, 4);
+        std::memcpy(&lsn, data.data() + pos + 8, 8);
+        if (pos + kHeaderBytes + len > data.size()) break; // torn write
+        if (crc32c(data.data() + pos + 8, 8 + len) != crc) break; // corrupt
+        if (lastLsn != 0 && lsn != lastLsn + 1) break; // stale bytes from an old run
+        fn(lsn, data.substr(pos + kHeaderBytes, len));
+        lastLsn = lsn;
+        pos += kHeaderBytes + len;
+    }
+    if (pos < data.size() && ::ftruncate(in, pos) != 0) {
+        ::close(in);
+        throw io::ioError("cannot cut torn tail of log", path);
+    }
+    ::close(in);
+    return lastLsn;
+}
+
+uint64_t WriteAheadLog::append(const std::string& payload) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (failed) throw std::runtime_error("log " + path + " failed earlier, refusing writes");
+    uint64_t lsn = nextLsn++;
+    std::string lsnAndPayload;
+    io::putU64(lsnAndPayload, lsn);
+    lsnAndPayload += payload;
+    io::putU32(pending, (uint32_t)payload.size());
+    io::putU32(pending, crc32c(lsnAndPayload.data(), lsnAndPayload.size()));
+    pending += lsnAndPayload;
+    return lsn;
+}
+
+void WriteAheadLog::flushLocked(std::unique_lock<std::mutex>& lock) {
+    flushing = true;
+    if (opt.commitWindowUs > 0) {
+        // let more writers join this group
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::microseconds(opt.commitWindowUs));
+        lock.lock();
+    }
+    std::string batch;
+    batch.swap(pending);
+    uint64_t upTo = nextLsn - 1;
+    lock.unlock();
+
+    bool ok = true;
+    {
+        INSTR_SCOPE("wal.group_commit");
+        ok = io::writeAll(fd, batch.data(), batch.size());
+        if (ok && opt.sync) ok = ::fdatasync(fd) == 0;
+    }
+    int savedErrno = errno;
+
+    lock.lock();
+    flushing = false;
+    if (ok) {
+        durableLsn = upTo;
+        groups++;
+    } else {
+        failed = true;
+    }
+    flushed.notify_all();
+    if (!ok) {
+        errno = savedErrno;
+        throw io::ioError("cannot write log", path);
+    }
+}
+
+void WriteAheadLog::waitDurable(uint64_t lsn) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (durableLsn < lsn) {
+        if (failed) throw std::runtime_error("log " + path + " failed, record not durable");
+        if (!flushing) {
+            flushLocked(lock);
+        } else {
+            flushed.wait(lock);
+        }
+    }
+}
+
+void WriteAheadLog::truncate() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (flushing) flushed.wait(lock);
+    if (!pending.empty()) flushLocked(lock);
+    if (::ftruncate(fd, 0) != 0 || (opt.sync && ::fdatasync(fd) != 0)) {
+        failed = true;
+        throw io::ioError("cannot truncate log", path);
+    }
+}
+
+uint64_t WriteAheadLog::getDurableLsn() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return durableLsn;
+}
+
+uint64_t WriteAheadLog::getGroupCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return groups;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+// CRC-32C (Castagnoli) of len bytes, chained through crc
+uint32_t crc32c(const void* data, size_t len, uint32_t crc = 0);
+
+// Append-only write-ahead log with group commit.
+//
+// Record layout: u32 payload length, u32 crc32c(lsn + payload), u64 lsn,
+// payload. append() only buffers a record; waitDurable() blocks until it
+// is on disk. The first waiter to find no flush in progress becomes the
+// leader: it waits up to commitWindowUs for more writers, then writes the
+// whole buffer with one write() and one fdatasync(); everyone whose
+// record was in that batch wakes up together.
+//
+// I/O errors throw std::runtime_error; after one the log refuses further
+// appends, since what reached the disk is unknown.
+class WriteAheadLog {
+public:
+    struct Options {
+        bool sync = true; // fdatasync per group; off only for throwaway data
+        int commitWindowUs = 0; // extra time a leader waits to grow its group
+    };
+
+    // opens (or creates) path for appending; nextLsn is one past the last
+    // record replay() returned
+    WriteAheadLog(const std::string& path, uint64_t nextLsn, Options opt);
+    ~WriteAheadLog();
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Calls fn for every intact record in order and cuts off a torn or
+    // corrupt tail so new appends follow the last good record. Returns the
+    // last lsn seen (0 for an empty or missing log).
+    static uint64_t replay(const std::string& path,
+                           const std::function<void(uint64_t lsn, const std::string& payload)>& fn);
+
+    uint64_t append(const std::string& payload);
+    void waitDurable(uint64_t lsn);
+    uint64_t commit(const std::string& payload) {
+        uint64_t lsn = append(payload);
+        waitDurable(lsn);
+        return lsn;
+    }
+
+    // flushes, then empties the log file (after a snapshot covered it)
+    void truncate();
+
+    uint64_t getDurableLsn();
+    uint64_t getGroupCount();
+
+private:
+    std::string path;
+    Options opt;
+    int fd = -1;
+
+    std::mutex mutex;
+    std::condition_variable flushed;
+    std::string pending; // encoded records not yet written
+    uint64_t nextLsn;
+    uint64_t durableLsn;
+    uint64_t groups = 0;
+    bool flushing = false;
+    bool failed = false;
+
+    void flushLocked(std::unique_lock<std::mutex>& lock);
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal checks for the tests/ executables: a failed CHECK prints where
+// and marks the run failed; main returns checkResult() as its exit code.
+namespace check {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline int checkResult() {
+    if (failures() == 0) std::printf("ok\n");
+    return failures() == 0 ? 0 : 1;
+}
+
+} // namespace check
+
+#define CHECK(cond)                                                           \
+    do {                                                                      \
+        if (!(cond)) {                                                        \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            check::failures()++;                                              \
+        }                                                                     \
+    } while (0)
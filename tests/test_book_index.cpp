@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "book_index.h"
+#include "check.h"
+#include "intersect.h"
+
+namespace {
+
+const char* kWords[] = {"war", "peace", "night", "river", "garden", "stone", "winter", "light",
+                        "house", "sea", "fire", "song", "city", "glass", "bird", "road"};
+const char* kNames[] = {"austen", "tolstoy", "woolf", "night", "stone", "orwell", "eliot", "river"};
+
+struct Record {
+    int id;
+    std::set<std::string> title, author;
+};
+
+// the index's scoring, done by scanning every book
+std::vector<SearchHit> bruteSearch(const std::vector<Record>& books, const std::string& query, size_t k) {
+    std::vector<std::string> words = BookIndex::tokenize(query);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    if (words.empty()) return {};
+    std::vector<double> idf;
+    for (auto& w : words) {
+        size_t df = 0;
+        for (auto& b : books) df += b.title.count(w) || b.author.count(w);
+        if (df == 0) return {};
+        idf.push_back(std::log(1.0 + (double)books.size() / df));
+    }
+    std::vector<SearchHit> hits;
+    for (auto& b : books) {
+        double score = 0;
+        bool all = true;
+        for (size_t t = 0; t < words.size() && all; t++) {
+            bool inTitle = b.title.count(words[t]) > 0;
+            all = inTitle || b.author.count(words[t]) > 0;
+            score += idf[t] * (inTitle ? 2.0 : 1.0);
+        }
+        if (all) hits.push_back({b.id, score});
+    }
+    std::sort(hits.begin(), hits.end(), [](const SearchHit& a, const SearchHit& b) {
+        // scores are summed in a different order than the index does, so
+        // equal patterns may differ in the last bits
+        if (std::fabs(a.score - b.score) > 1e-9) return a.score > b.score;
+        return a.bookId < b.bookId;
+    });
+    if (hits.size() > k) hits.resize(k);
+    return hits;
+}
+
+bool sameHits(const std::vector<SearchHit>& got, const std::vector<SearchHit>& want) {
+    if (got.size() != want.size()) return false;
+    for (size_t i = 0; i < got.size(); i++) {
+        if (got[i].bookId != want[i].bookId || std::fabs(got[i].score - want[i].score) > 1e-9) return false;
+    }
+    return true;
+}
+
+Book randomBook(std::mt19937& rng, std::vector<Record>& records) {
+    std::string title, author;
+    int words = 1 + (int)(rng() % 4);
+    for (int w = 0; w < words; w++) {
+        // skewed, so some terms have long lists spanning many blocks
+        title += std::string(kWords[std::min(rng() % 16, rng() % 16)]) + (w + 1 < words ? " " : "");
+    }
+    author = std::string(kNames[rng() % 8]) + " " + kNames[rng() % 8];
+    Book b(title, author);
+    auto tokens = [](const std::string& s) {
+        auto t = BookIndex::tokenize(s);
+        return std::set<std::string>(t.begin(), t.end());
+    };
+    records.push_back({b.getId(), tokens(title), tokens(author)});
+    return b;
+}
+
+int compareQueries(const BookIndex& index, const std::vector<Record>& records, std::mt19937& rng) {
+    int mismatches = 0;
+    for (int q = 0; q < 400; q++) {
+        std::string query = kWords[rng() % 16];
+        int extra = (int)(rng() % 3);
+        for (int e = 0; e < extra; e++) query += std::string(" ") + (rng() % 2 ? kWords[rng() % 16] : kNames[rng() % 8]);
+        size_t k = q % 4 == 0 ? 1000000 : 10;
+        mismatches += !sameHits(index.search(query, k), bruteSearch(records, query, k));
+    }
+    return mismatches;
+}
+
+void searchMatchesBruteForce() {
+    std::mt19937 rng(31);
+    BookIndex index;
+    std::vector<Record> records;
+    for (int i = 0; i < 4000; i++) index.add(randomBook(rng, records));
+    CHECK(index.getBookCount() == 4000);
+    CHECK(compareQueries(index, records, rng) == 0);
+    CHECK(index.search("", 10).empty());
+    CHECK(index.search("war unknownword", 10).empty());
+    CHECK(index.search("war", 0).empty());
+}
+
+// an id gap of 2^30 or more used to overflow the 32-bit delta << 2 and
+// corrupt every later posting in the list
+void largeIdGaps() {
+    std::mt19937 rng(32);
+    BookIndex index;
+    std::vector<Record> records;
+    for (int i = 0; i < 300; i++) index.add(randomBook(rng, records));
+    Book::reserveIds(records.back().id + (1 << 30) + 7);
+    for (int i = 0; i < 300; i++) index.add(randomBook(rng, records));
+    Book::reserveIds(records.back().id + (1 << 29));
+    for (int i = 0; i < 300; i++) index.add(randomBook(rng, records));
+    CHECK(compareQueries(index, records, rng) == 0);
+}
+
+std::vector<uint32_t> randomList(std::mt19937& rng, size_t n, uint32_t base, uint32_t spread) {
+    std::set<uint32_t> values;
+    while (values.size() < n) values.insert(base + (uint32_t)(rng() % spread));
+    return std::vector<uint32_t>(values.begin(), values.end());
+}
+
+void intersectionsMatchReference() {
+    std::mt19937 rng(33);
+    int mismatches = 0;
+    for (int round = 0; round < 2000; round++) {
+        size_t na = rng() % 300, nb = rng() % 300;
+        if (round % 5 == 0) nb = rng() % 8; // skewed: the galloping path
+        uint32_t spread = 64 + (uint32_t)(rng() % 2000);
+        uint32_t base = round % 3 == 0 ? 0xfffff000u - spread : (uint32_t)(rng() % 1000); // include values above INT32_MAX
+        auto a = randomList(rng, std::min<size_t>(na, spread), base, spread);
+        auto b = randomList(rng, std::min<size_t>(nb, spread), base, spread);
+        std::vector<uint32_t> want;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(want));
+
+        std::vector<uint32_t> out(std::min(a.size(), b.size()) + 1);
+        for (auto fn : {intersectScalar, intersectSimd, intersectSorted}) {
+            size_t n = fn(a.data(), a.size(), b.data(), b.size(), out.data());
+            mismatches += std::vector<uint32_t>(out.begin(), out.begin() + n) != want;
+            n = fn(b.data(), b.size(), a.data(), a.size(), out.data());
+            mismatches += std::vector<uint32_t>(out.begin(), out.begin() + n) != want;
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+} // namespace
+
+int main() {
+    searchMatchesBruteForce();
+    intersectionsMatchReference();
+    largeIdGaps(); // last: moves the process-wide Book ids up near 2^31
+    return check::checkResult();
+}
@@ -0,0 +1,253 @@
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catalog.h"
+#include "check.h"
+#include "wal.h"
+
+namespace {
+
+const Library kLibrary("Test Library", "1 Test Road");
+
+// a new directory under /tmp, removed again at scope exit
+struct TempDir {
+    std::string path;
+    TempDir() {
+        char tmpl[] = "/tmp/practice_catalog_XXXXXX";
+        if (!::mkdtemp(tmpl)) throw std::runtime_error("mkdtemp failed");
+        path = tmpl;
+    }
+    ~TempDir() { std::filesystem::remove_all(path); }
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+};
+
+LibraryCatalog::Options noSync() {
+    LibraryCatalog::Options opt;
+    opt.log.sync = false;
+    return opt;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& path, const std::string& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << data;
+}
+
+off_t fileSize(const std::string& path) {
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+void replay() {
+    TempDir tmp;
+    std::string dir = tmp.path;
+    Book a("Dune", "Herbert"), b("Emma", "Austen"), c("Ulysses", "Joyce");
+    {
+        auto cat = LibraryCatalog::open(dir, kLibrary, noSync());
+        cat->addBook(a);
+        cat->addBook(b);
+        cat->addBook(c);
+        cat->updateBook(b.getId(), "Persuasion", "Austen");
+        cat->removeBook(c.getId());
+    }
+    auto cat = LibraryCatalog::open(dir, kLibrary, noSync());
+    CHECK(cat->getSize() == 2);
+    CHECK(cat->find(a.getId())->title == "Dune");
+    CHECK(cat->find(b.getId())->title == "Persuasion");
+    CHECK(!cat->find(c.getId()));
+
+    std::vector<uint64_t> lsns;
+    WriteAheadLog::replay(dir + "/wal.log", [&](uint64_t lsn, const std::string&) { lsns.push_back(lsn); });
+    CHECK((lsns == std::vector<uint64_t>{1, 2, 3, 4, 5}));
+}
+
+// a crash in the middle of a write leaves a partial record at the end:
+// replay keeps everything before it and cuts it off
+void tornTail() {
+    TempDir tmp;
+    std::string dir = tmp.path, wal = dir + "/wal.log";
+    Book a("A", "x"), b("B", "x");
+    {
+        auto cat = LibraryCatalog::open(dir, kLibrary, noSync());
+        cat->addBook(a);
+        cat->addBook(b);
+    }
+    off_t whole = fileSize(wal);
+    std::string data = readFile(wal);
+    // a header that promises more payload than follows
+    std::string torn = data.substr(0, 16 + 3);
+    writeFile(wal, data + torn);
+    {
+        auto cat = LibraryCatalog::open(dir, kLibrary, noSync());
+        CHECK(cat->getSize() == 2);
+        CHECK(fileSize(wal) == whole);
+        // the log keeps going after the cut
+        Book c("C", "x");
+        cat->addBook(c);
+    }
+    // half a header
+    writeFile(wal, readFile(wal) + std::string(7, '\x01'));
+    auto cat = LibraryCatalog::open(dir, kLibrary, noSync());
+    CHECK(cat->getSize() == 3);
+    CHECK(fileSize(wal) > whole);
+}
+
+// a record whose checksum does not match ends the log there
+void crcMismatch() {
+    TempDir tmp;
+    std::string dir = tmp.path, wal = dir + "/wal.log";
+    Book a("A", "x"), b("B", "x");
+    off_t firstRecord;
+    {
+        auto cat = LibraryCatalog::open(dir, kLibrary, noSync());
+        cat->addBook(a);
+        firstRecord = fileSize(wal);
+        cat->addBook(b);
+        cat->updateBook(a.getId(), "A2", "x");
+    }
+    std::string data = readFile(wal);
+    data[firstRecord + 16 + 6] ^= 0x20; // a byte of the second record's payload
+    writeFile(wal, data);
+
+    auto cat = LibraryCatalog::open(dir, kLibrary, noSync());
+    CHECK(cat->getSize() == 1);
+    CHECK(cat->find(a.getId())->title == "A");
+    CHECK(!cat->find(b.getId()));
+    CHECK(fileSize(wal) == firstRecord);
+}
+
+void compactThenReopen() {
+    TempDir tmp;
+    std::string dir = tmp.path;
+    std::vector<int> ids;
+    {
+        auto cat = LibraryCatalog::open(dir, kLibrary, noSync());
+        for (int i = 0; i < 50; i++) {
+            Book b(std::to_string(i), "x");
+            ids.push_back(b.getId());
+            cat->addBook(b);
+        }
+        cat->removeBook(ids[0]);
+        cat->compact();
+        CHECK(fileSize(dir + "/wal.log") == 0);
+        // changes after the snapshot go to the emptied log
+        cat->updateBook(ids[1], "after", "x");
+        Book late("late", "x");
+        ids.push_back(late.getId());
+        cat->addBook(late);
+    }
+    auto cat = LibraryCatalog::open(dir, kLibrary, noSync());
+    CHECK(cat->getSize() == 50);
+    CHECK(!cat->find(ids[0]));
+    CHECK(cat->find(ids[1])->title == "after");
+    CHECK(cat->find(ids[49])->title == "49");
+    CHECK(cat->find(ids.back())->title == "late");
+    CHECK(cat->getLibrary().getName() == "Test Library");
+
+    // automatic compaction
+    TempDir tmp2;
+    std::string dir2 = tmp2.path;
+    LibraryCatalog::Options opt = noSync();
+    opt.compactAfterRecords = 8;
+    {
+        auto auto_ = LibraryCatalog::open(dir2, kLibrary, opt);
+        for (int i = 0; i < 20; i++) auto_->addBook(Book("x", "y"));
+    }
+    CHECK(LibraryCatalog::open(dir2, kLibrary, opt)->getSize() == 20);
+}
+
+// a fresh process starts its Book ids at 1; opening a catalog has to move
+// them past every id the catalog already holds
+void idsReservedPastReplayed() {
+    TempDir tmp;
+    std::string dir = tmp.path;
+    pid_t child = ::fork();
+    if (child == 0) {
+        auto cat = LibraryCatalog::open(dir, kLibrary, noSync());
+        for (int i = 0; i < 5000; i++) Book("burn", "ids");
+        cat->addBook(Book("high", "id"));
+        std::_Exit(0);
+    }
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    auto cat = LibraryCatalog::open(dir, kLibrary, noSync());
+    CHECK(cat->getSize() == 1);
+    Book next("next", "x");
+    CHECK(next.getId() > 5000);
+    cat->addBook(next); // would throw if the id were already taken
+    CHECK(cat->getSize() == 2);
+}
+
+// a log write that fails must not leave the change visible in memory
+void failedWriteRollsBack() {
+    TempDir tmp;
+    std::string dir = tmp.path, wal = dir + "/wal.log";
+    Book a("A", "x");
+    auto cat = LibraryCatalog::open(dir, kLibrary, noSync());
+    cat->addBook(a);
+
+    // cap the file size at what is already written, so the next write fails
+    std::signal(SIGXFSZ, SIG_IGN);
+    struct rlimit saved;
+    ::getrlimit(RLIMIT_FSIZE, &saved);
+    struct rlimit capped = saved;
+    capped.rlim_cur = (rlim_t)fileSize(wal);
+    ::setrlimit(RLIMIT_FSIZE, &capped);
+
+    Book b("B", "x");
+    bool threw = false;
+    try {
+        cat->addBook(b);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(!cat->find(b.getId()));
+    CHECK(cat->getSize() == 1);
+
+    threw = false;
+    try {
+        cat->updateBook(a.getId(), "changed", "x");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(cat->find(a.getId())->title == "A");
+
+    ::setrlimit(RLIMIT_FSIZE, &saved);
+    cat.reset();
+    auto reopened = LibraryCatalog::open(dir, kLibrary, noSync());
+    CHECK(reopened->getSize() == 1);
+    CHECK(reopened->find(a.getId())->title == "A");
+}
+
+} // namespace
+
+int main() {
+    replay();
+    tornTail();
+    crcMismatch();
+    compactThenReopen();
+    idsReservedPastReplayed();
+    failedWriteRollsBack();
+    return check::checkResult();
+}
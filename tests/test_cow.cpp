@@ -0,0 +1,74 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "check.h"
+#include "cow.h"
+#include "cow_vector.h"
+
+namespace {
+
+void copyFromMovedFrom() {
+    Cow<std::string> s("text");
+    Cow<std::string> t(std::move(s));
+    CHECK(s.useCount() == 0);
+    CHECK(s.get().empty());
+    Cow<std::string> u(s);
+    CHECK(u.get().empty());
+    Cow<std::string> deep = s.make_unique_copy();
+    CHECK(deep.get().empty());
+}
+
+void assignToAndFromMovedFrom() {
+    Cow<std::string> a("a"), b("b");
+    Cow<std::string> moved(std::move(a));
+
+    // assign from a moved-from holder
+    b = a;
+    CHECK(b.get().empty());
+    CHECK(b.useCount() == 0);
+
+    // assign to a moved-from holder, copy and move
+    a = moved;
+    CHECK(a.get() == "a");
+    CHECK(a.isShared() && moved.useCount() == 2);
+    Cow<std::string> c("c");
+    Cow<std::string> d(std::move(c));
+    c = std::move(d);
+    CHECK(c.get() == "c");
+
+    // writing through a moved-from holder gives it a fresh value
+    d.mut().push_back('d');
+    CHECK(d.get() == "d" && d.useCount() == 1);
+}
+
+void copyFromNonConstLvalue() {
+    Cow<std::vector<int>> a(3, 4);
+    Cow<std::vector<int>> b(a);
+    CHECK(b.get().size() == 3 && b.useCount() == 2);
+    Cow<std::vector<int>> c;
+    c = a;
+    CHECK(a.useCount() == 3);
+    c.mut().push_back(1);
+    CHECK(a.get().size() == 3 && c.get().size() == 4 && a.useCount() == 2);
+}
+
+void cowVectorMovedFrom() {
+    CowVector a;
+    a.push_back(1);
+    CowVector b(std::move(a));
+    CowVector c(a);
+    CHECK(c.getSize() == 0);
+    a = b;
+    CHECK(a.getSize() == 1 && a.get(0) == 1);
+}
+
+} // namespace
+
+int main() {
+    copyFromMovedFrom();
+    assignToAndFromMovedFrom();
+    copyFromNonConstLvalue();
+    cowVectorMovedFrom();
+    return check::checkResult();
+}
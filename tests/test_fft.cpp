@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "check.h"
+#include "fft.h"
+
+namespace {
+
+// single precision against a double-precision reference: errors are
+// relative to the largest bin
+const double kTolerance = 2e-5;
+
+SplitComplex noise(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    SplitComplex x(n);
+    for (size_t i = 0; i < n; i++) {
+        x.re[i] = u(rng);
+        x.im[i] = u(rng);
+    }
+    return x;
+}
+
+double relError(const float* re, const float* im, const double* wantRe, const double* wantIm, size_t n) {
+    double err = 0, peak = 1e-30;
+    for (size_t k = 0; k < n; k++) {
+        err = std::max(err, std::hypot(re[k] - wantRe[k], im[k] - wantIm[k]));
+        peak = std::max(peak, std::hypot(wantRe[k], wantIm[k]));
+    }
+    return err / peak;
+}
+
+double maxDiff(const std::vector<float>& a, const std::vector<float>& b) {
+    double d = 0;
+    for (size_t i = 0; i < a.size(); i++) d = std::max(d, (double)std::fabs(a[i] - b[i]));
+    return d;
+}
+
+void checkComplex(size_t n) {
+    SplitComplex x = noise(n, (unsigned)n);
+    std::vector<double> wantRe(n), wantIm(n);
+    naiveDft(x.re.data(), x.im.data(), n, wantRe.data(), wantIm.data());
+
+    auto plan = FftPlan::get(n);
+    SplitComplex y = x;
+    plan->forward(y);
+    double err = relError(y.re.data(), y.im.data(), wantRe.data(), wantIm.data(), n);
+    if (err > kTolerance) std::fprintf(stderr, "n=%zu forward error %g\n", n, err);
+    CHECK(err <= kTolerance);
+
+    plan->inverse(y);
+    double back = std::max(maxDiff(y.re, x.re), maxDiff(y.im, x.im));
+    if (back > kTolerance) std::fprintf(stderr, "n=%zu round trip error %g\n", n, back);
+    CHECK(back <= kTolerance);
+}
+
+void checkReal(size_t n) {
+    SplitComplex x = noise(n, (unsigned)n + 1);
+    std::vector<float> zeros(n, 0.0f);
+    std::vector<double> wantRe(n), wantIm(n);
+    naiveDft(x.re.data(), zeros.data(), n, wantRe.data(), wantIm.data());
+
+    auto plan = RealFftPlan::get(n);
+    CHECK(plan->getBinCount() == n / 2 + 1);
+    std::vector<float> binRe(plan->getBinCount()), binIm(plan->getBinCount());
+    plan->forward(x.re.data(), binRe.data(), binIm.data());
+    double err = relError(binRe.data(), binIm.data(), wantRe.data(), wantIm.data(), plan->getBinCount());
+    if (err > kTolerance) std::fprintf(stderr, "real n=%zu forward error %g\n", n, err);
+    CHECK(err <= kTolerance);
+
+    std::vector<float> back(n);
+    plan->inverse(binRe.data(), binIm.data(), back.data());
+    double diff = maxDiff(back, x.re);
+    if (diff > kTolerance) std::fprintf(stderr, "real n=%zu round trip error %g\n", n, diff);
+    CHECK(diff <= kTolerance);
+}
+
+void powerOfTwo() {
+    for (size_t n : {1, 2, 4, 8, 16, 32, 64, 128, 1024, 4096}) checkComplex(n);
+    CHECK(FftPlan::get(4096)->getFactors().size() == 6); // six radix-4 stages
+}
+
+void mixedRadix() {
+    for (size_t n : {6, 12, 20, 60, 96, 1000, 1536}) checkComplex(n);
+}
+
+void genericRadix() {
+    // odd primes up to kMaxRadix get the generic butterfly
+    for (size_t n : {3, 5, 7, 31, 243, 1001, 3 * 29 * 4}) {
+        CHECK(!FftPlan::get(n)->usesBluestein());
+        checkComplex(n);
+    }
+}
+
+void bluestein() {
+    // a prime factor above kMaxRadix
+    for (size_t n : {37, 74, 1009, 4 * 97}) {
+        CHECK(FftPlan::get(n)->usesBluestein());
+        checkComplex(n);
+    }
+}
+
+void realPlans() {
+    for (size_t n : {2, 4, 16, 74, 1000, 4096}) checkReal(n); // even: half-size packing
+    for (size_t n : {1, 3, 15, 37, 243}) checkReal(n);        // odd: full complex transform
+}
+
+// above parallel::kParallelThreshold stages are split across the pool;
+// the result must not depend on the thread count
+void threadedMatchesSerial() {
+    size_t n = 1 << 17;
+    SplitComplex x = noise(n, 17);
+    SplitComplex serial = x, threaded = x;
+    ThreadPool single(1), four(4);
+    auto plan = FftPlan::get(n);
+    plan->forward(serial, single);
+    plan->forward(threaded, four);
+    CHECK(serial.re == threaded.re && serial.im == threaded.im);
+    plan->inverse(threaded, four);
+    CHECK(std::max(maxDiff(threaded.re, x.re), maxDiff(threaded.im, x.im)) <= kTolerance);
+}
+
+void wrappers() {
+    std::vector<Complex> x = {Complex(1, 0), Complex(2, -1), Complex(0, 3), Complex(-1, 1), Complex(5, 0)};
+    std::vector<Complex> y = ifft(fft(x));
+    CHECK(y.size() == x.size());
+    for (size_t i = 0; i < x.size(); i++) CHECK((y[i] - x[i]).abs() < 1e-5f);
+}
+
+} // namespace
+
+int main() {
+    powerOfTwo();
+    mixedRadix();
+    genericRadix();
+    bluestein();
+    realPlans();
+    threadedMatchesSerial();
+    wrappers();
+    return check::checkResult();
+}
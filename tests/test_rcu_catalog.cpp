@@ -0,0 +1,173 @@
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "epoch.h"
+#include "rcu_catalog.h"
+
+namespace {
+
+std::vector<int> scanIds(const RcuCatalog::Snapshot& snap) {
+    std::vector<int> ids;
+    snap.forEach([&](const CatalogEntry& e) { ids.push_back(e.id); });
+    return ids;
+}
+
+// a full reader slot table must not leave the thread half-locked: its
+// next readLock() has to announce an epoch again
+void readLockWhenSlotsRunOut() {
+    std::atomic<int> holding{0};
+    std::atomic<bool> release{false};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < epoch::kMaxReaderThreads; i++) {
+        readers.emplace_back([&] {
+            epoch::readLock();
+            holding++;
+            while (!release.load()) std::this_thread::yield();
+            epoch::readUnlock();
+        });
+    }
+    while (holding.load() < epoch::kMaxReaderThreads) std::this_thread::yield();
+
+    bool threw = false, announced = false;
+    std::thread late([&] {
+        try {
+            epoch::readLock();
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        release = true;
+        while (holding.load() > 0) std::this_thread::yield();
+        epoch::readLock();
+        announced = epoch::oldestActiveEpoch() != UINT64_MAX;
+        epoch::readUnlock();
+    });
+    for (auto& t : readers) {
+        t.join();
+        holding--;
+    }
+    late.join();
+    CHECK(threw);
+    CHECK(announced);
+    CHECK(epoch::oldestActiveEpoch() == UINT64_MAX);
+}
+
+void nestedReadLock() {
+    epoch::readLock();
+    uint64_t outer = epoch::oldestActiveEpoch();
+    CHECK(outer != UINT64_MAX);
+    epoch::readLock();
+    epoch::retireEpoch();
+    epoch::readUnlock();
+    // still inside the outer lock, still announcing the outer epoch
+    CHECK(epoch::oldestActiveEpoch() == outer);
+    CHECK(!epoch::canFree(outer));
+    epoch::readUnlock();
+    CHECK(epoch::oldestActiveEpoch() == UINT64_MAX);
+    CHECK(epoch::canFree(outer));
+
+    RcuCatalog catalog;
+    catalog.addBook(Book("a", "x"));
+    {
+        auto outerSnap = catalog.snapshot();
+        {
+            auto innerSnap = catalog.snapshot();
+            catalog.addBook(Book("b", "x"));
+            CHECK(innerSnap.getSize() == 1);
+        }
+        catalog.addBook(Book("c", "x"));
+        catalog.reclaim();
+        // the outer snapshot still pins the first version
+        CHECK(outerSnap.getSize() == 1);
+        CHECK(catalog.getRetiredCount() > 0);
+    }
+}
+
+void retiredFreedAfterReaders() {
+    RcuCatalog catalog;
+    std::vector<int> ids;
+    for (int i = 0; i < 600; i++) {
+        Book b("title", "author");
+        ids.push_back(b.getId());
+        catalog.addBook(b);
+    }
+    CHECK(catalog.reclaim() == 0 && catalog.getRetiredCount() == 0);
+
+    {
+        auto snap = catalog.snapshot();
+        const CatalogEntry* e = snap.find(ids[10]);
+        catalog.updateBook(ids[10], "changed", "author");
+        catalog.removeBook(ids[20]);
+        catalog.reclaim();
+        CHECK(catalog.getRetiredCount() == 2);
+        // what the snapshot pinned is still there and unchanged
+        CHECK(e && e->title == "title");
+        CHECK(snap.find(ids[20]) != nullptr);
+    }
+    CHECK(catalog.reclaim() == 2);
+    CHECK(catalog.getRetiredCount() == 0);
+    auto now = catalog.snapshot();
+    CHECK(now.find(ids[10])->title == "changed");
+    CHECK(now.find(ids[20]) == nullptr);
+    CHECK(now.getSize() == 599);
+}
+
+// readers scan snapshots while a writer adds, updates and removes: each
+// snapshot must stay internally consistent and unchanged while held
+void concurrentSnapshots() {
+    RcuCatalog catalog;
+    std::vector<int> ids;
+    for (int i = 0; i < 1000; i++) {
+        Book b("title", "author");
+        ids.push_back(b.getId());
+        catalog.addBook(b);
+    }
+    std::atomic<bool> done{false};
+    std::atomic<int> bad{0}, scans{0};
+
+    std::thread writer([&] {
+        for (int round = 0; round < 3000; round++) {
+            Book b("new", "author");
+            catalog.addBook(b);
+            catalog.updateBook(ids[round % ids.size()], "updated", "author");
+            if (round % 3 == 0) catalog.removeBook(b.getId());
+        }
+        done = true;
+    });
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; r++) {
+        readers.emplace_back([&] {
+            uint64_t lastVersion = 0;
+            while (!done.load() || scans.load() < 10) {
+                auto snap = catalog.snapshot();
+                std::vector<int> first = scanIds(snap);
+                bool sorted = true;
+                for (size_t i = 1; i < first.size(); i++) sorted &= first[i - 1] < first[i];
+                if (!sorted || first.size() != snap.getSize() || snap.getVersion() < lastVersion) bad++;
+                std::this_thread::yield();
+                if (scanIds(snap) != first) bad++;
+                lastVersion = snap.getVersion();
+                scans++;
+            }
+        });
+    }
+    writer.join();
+    for (auto& t : readers) t.join();
+    CHECK(bad.load() == 0);
+    catalog.reclaim();
+    CHECK(catalog.getRetiredCount() == 0);
+    CHECK(catalog.snapshot().getSize() == 1000 + 3000 - 1000);
+}
+
+} // namespace
+
+int main() {
+    readLockWhenSlotsRunOut();
+    nestedReadLock();
+    retiredFreedAfterReaders();
+    concurrentSnapshots();
+    return check::checkResult();
+}
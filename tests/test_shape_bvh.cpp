@@ -0,0 +1,164 @@
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "check.h"
+#include "shape_bvh.h"
+
+namespace {
+
+struct Scene {
+    std::vector<std::unique_ptr<Shape>> shapes;
+    std::vector<Shape*> pointers;
+};
+
+Scene randomScene(size_t n, double extent, std::mt19937& rng) {
+    std::uniform_real_distribution<double> pos(0.0, extent);
+    std::uniform_real_distribution<double> size(0.5, 20.0);
+    Scene s;
+    for (size_t i = 0; i < n; i++) {
+        double x = pos(rng), y = pos(rng);
+        switch (i % 3) {
+        case 0: s.shapes.push_back(std::make_unique<Circle>(size(rng), x, y)); break;
+        case 1: s.shapes.push_back(std::make_unique<Rectangle>(size(rng), size(rng), x, y)); break;
+        default: s.shapes.push_back(std::make_unique<Square>(size(rng), x, y)); break;
+        }
+        s.pointers.push_back(s.shapes.back().get());
+    }
+    return s;
+}
+
+Shape* brutePickPoint(const Scene& s, double x, double y) {
+    Shape* hit = nullptr;
+    for (Shape* shape : s.pointers) {
+        if (shape->contains(x, y)) hit = shape;
+    }
+    return hit;
+}
+
+std::vector<Shape*> brutePickRect(const Scene& s, const Aabb& r) {
+    std::vector<Shape*> out;
+    for (Shape* shape : s.pointers) {
+        if (shape->bounds().overlaps(r)) out.push_back(shape);
+    }
+    return out;
+}
+
+// runs fn with std::cout captured, returns what it printed
+template <typename Fn>
+std::string captureCout(Fn fn) {
+    std::ostringstream text;
+    std::streambuf* saved = std::cout.rdbuf(text.rdbuf());
+    fn();
+    std::cout.rdbuf(saved);
+    return text.str();
+}
+
+Aabb randomRect(double extent, std::mt19937& rng) {
+    std::uniform_real_distribution<double> pos(-50.0, extent + 50.0);
+    std::uniform_real_distribution<double> size(0.0, extent / 4);
+    double x = pos(rng), y = pos(rng);
+    return {x, y, x + size(rng), y + size(rng)};
+}
+
+// every query against a linear scan of the scene
+int compareQueries(const Scene& s, ShapeBvh& bvh, double extent, std::mt19937& rng) {
+    int mismatches = 0;
+    std::uniform_real_distribution<double> pos(0.0, extent);
+    for (int q = 0; q < 300; q++) {
+        double x = pos(rng), y = pos(rng);
+        // half the points aim at a shape's centre so most of them hit
+        if (q % 2) {
+            Shape* target = s.pointers[rng() % s.pointers.size()];
+            x = target->getX();
+            y = target->getY();
+        }
+        mismatches += bvh.pickPoint(x, y) != brutePickPoint(s, x, y);
+    }
+    for (int q = 0; q < 100; q++) {
+        Aabb r = randomRect(extent, rng);
+        std::vector<Shape*> got;
+        bvh.pickRect(r, got);
+        mismatches += got != brutePickRect(s, r);
+    }
+    for (int q = 0; q < 10; q++) {
+        Aabb view = randomRect(extent, rng);
+        size_t drawn = 0;
+        std::string got = captureCout([&] { drawn = bvh.drawVisible(view); });
+        std::vector<Shape*> want = brutePickRect(s, view);
+        std::string expected = captureCout([&] {
+            for (Shape* shape : want) shape->draw();
+        });
+        mismatches += drawn != want.size() || got != expected;
+    }
+    return mismatches;
+}
+
+void randomSceneQueries() {
+    std::mt19937 rng(35);
+    const double extent = 2000;
+    Scene s = randomScene(5000, extent, rng);
+    ShapeBvh bvh(s.pointers);
+    CHECK(bvh.getSize() == 5000);
+    CHECK(compareQueries(s, bvh, extent, rng) == 0);
+}
+
+// refit keeps the tree but must pick up every moved shape's new bounds
+void queriesAfterRefit() {
+    std::mt19937 rng(36);
+    const double extent = 2000;
+    Scene s = randomScene(5000, extent, rng);
+    ShapeBvh bvh(s.pointers);
+    double built = bvh.getSahCost();
+
+    std::uniform_real_distribution<double> step(-40.0, 40.0);
+    std::uniform_real_distribution<double> anywhere(0.0, extent);
+    for (int round = 0; round < 3; round++) {
+        for (size_t i = 0; i < s.pointers.size(); i++) {
+            Shape* shape = s.pointers[i];
+            if (i % 3 == 0) {
+                shape->setPosition(shape->getX() + step(rng), shape->getY() + step(rng));
+            } else if (i % 17 == 0) {
+                shape->setPosition(anywhere(rng), anywhere(rng)); // far jumps stretch the tree
+            }
+        }
+        bvh.refit();
+        CHECK(compareQueries(s, bvh, extent, rng) == 0);
+    }
+    CHECK(bvh.getSahCost() > built);
+    bvh.build();
+    CHECK(compareQueries(s, bvh, extent, rng) == 0);
+}
+
+void degenerateScenes() {
+    std::mt19937 rng(37);
+    ShapeBvh empty;
+    CHECK(empty.pickPoint(0, 0) == nullptr);
+    std::vector<Shape*> none;
+    empty.pickRect({-1e9, -1e9, 1e9, 1e9}, none);
+    CHECK(none.empty());
+
+    // every shape in one spot: SAH cannot split, the median fallback must
+    Scene stacked;
+    for (int i = 0; i < 3000; i++) {
+        stacked.shapes.push_back(std::make_unique<Square>(2.0, 10.0, 10.0));
+        stacked.pointers.push_back(stacked.shapes.back().get());
+    }
+    ShapeBvh bvh(stacked.pointers);
+    CHECK(bvh.pickPoint(10.5, 10.5) == stacked.pointers.back());
+    std::vector<Shape*> all;
+    bvh.pickRect({9, 9, 11, 11}, all);
+    CHECK(all == stacked.pointers);
+    CHECK(compareQueries(stacked, bvh, 20, rng) == 0);
+}
+
+} // namespace
+
+int main() {
+    randomSceneQueries();
+    queriesAfterRefit();
+    degenerateScenes();
+    return check::checkResult();
+}
@@ -0,0 +1,104 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "parallel.h"
+#include "thread_pool.h"
+
+namespace {
+
+// spins until cond() or about a second has passed; returns cond()
+template <typename Cond>
+bool waitFor(Cond cond) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (!cond() && std::chrono::steady_clock::now() < deadline) std::this_thread::yield();
+    return cond();
+}
+
+void throwingTransform() {
+    ThreadPool pool(4);
+    std::vector<int> v(1 << 18, 1);
+    v[v.size() / 2] = -1;
+    bool caught = false;
+    try {
+        parallel::transform(v.data(), v.data() + v.size(), [](int x) {
+            if (x < 0) throw std::runtime_error("negative");
+            return x * 2;
+        }, pool);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    CHECK(caught);
+
+    // the pool is still usable afterwards
+    std::vector<int> w(1 << 18, 3);
+    parallel::transform(w.data(), w.data() + w.size(), [](int x) { return x + 1; }, pool);
+    CHECK(w.front() == 4 && w.back() == 4);
+}
+
+// the calling thread throws while workers are still inside their tasks:
+// run() must wait for them, then rethrow
+void callerThrowsWhileWorkersRun() {
+    ThreadPool pool(4);
+    const auto caller = std::this_thread::get_id();
+    std::atomic<bool> callerFailed{false};
+    std::atomic<int> started{0}, finished{0};
+    bool caught = false;
+    try {
+        pool.run(64, [&](int) {
+            if (std::this_thread::get_id() == caller) {
+                callerFailed = true;
+                throw std::logic_error("caller");
+            }
+            started++;
+            waitFor([&] { return callerFailed.load(); });
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            finished++;
+        });
+    } catch (const std::logic_error&) {
+        caught = true;
+    }
+    CHECK(caught);
+    CHECK(started.load() == finished.load());
+
+    // the caller no longer counts as inside the pool, so a new job still
+    // reaches the workers instead of running inline
+    std::atomic<int> running{0};
+    std::atomic<bool> overlapped{false};
+    pool.run(4, [&](int) {
+        running++;
+        if (waitFor([&] { return running.load() >= 2; })) overlapped = true;
+    });
+    CHECK(overlapped.load());
+}
+
+void workerThrows() {
+    ThreadPool pool(4);
+    const auto caller = std::this_thread::get_id();
+    std::atomic<bool> workerRan{false};
+    bool caught = false;
+    try {
+        pool.run(64, [&](int) {
+            if (std::this_thread::get_id() != caller) {
+                workerRan = true;
+                throw std::runtime_error("worker");
+            }
+            waitFor([&] { return workerRan.load(); });
+        });
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    CHECK(caught);
+}
+
+} // namespace
+
+int main() {
+    throwingTransform();
+    callerThrowsWhileWorkersRun();
+    workerThrows();
+    return check::checkResult();
+}
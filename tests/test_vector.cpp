@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "check.h"
+#include "parallel.h"
+#include "vector.h"
+
+namespace {
+
+Vector iota(int n) {
+    Vector v;
+    for (int i = 0; i < n; i++) v.push_back(i);
+    return v;
+}
+
+std::vector<int> contents(const Vector& v) {
+    return std::vector<int>(v.begin(), v.end());
+}
+
+void appendFromSelf() {
+    // whole vector, with and without room to spare
+    for (int extra : {0, 100}) {
+        Vector v = iota(5);
+        v.reserve(5 + extra);
+        v.append(std::span<const int>(v.begin(), v.end()));
+        CHECK((contents(v) == std::vector<int>{0, 1, 2, 3, 4, 0, 1, 2, 3, 4}));
+    }
+    // a slice in the middle, forcing a reallocation
+    Vector v = iota(8);
+    while (v.getSize() < v.getCapacity()) v.pop_back(); // no spare room
+    int n = v.getSize();
+    std::vector<int> want = contents(v);
+    want.insert(want.end(), want.begin() + 2, want.begin() + 5);
+    v.append(std::span<const int>(v.begin() + 2, 3));
+    CHECK(v.getSize() == n + 3);
+    CHECK(contents(v) == want);
+}
+
+void insertFromSelf() {
+    Vector v = iota(6);
+    v.insert(2, std::span<const int>(v.begin() + 3, 3));
+    CHECK((contents(v) == std::vector<int>{0, 1, 3, 4, 5, 2, 3, 4, 5}));
+
+    Vector w = iota(4);
+    w.reserve(100); // no reallocation: only the shift can clobber the source
+    w.insert(0, std::span<const int>(w.begin(), w.end()));
+    CHECK((contents(w) == std::vector<int>{0, 1, 2, 3, 0, 1, 2, 3}));
+
+    Vector x = iota(3);
+    x.insert(3, std::span<const int>(x.begin(), 2)); // at the end
+    CHECK((contents(x) == std::vector<int>{0, 1, 2, 0, 1}));
+}
+
+void resizeFill() {
+    Vector v = iota(4);
+    v.resize(7, -1);
+    CHECK((contents(v) == std::vector<int>{0, 1, 2, 3, -1, -1, -1}));
+    v.resize(2);
+    CHECK((contents(v) == std::vector<int>{0, 1}));
+    // growing again fills: the old values past size must not come back
+    v.resize(5, 9);
+    CHECK((contents(v) == std::vector<int>{0, 1, 9, 9, 9}));
+    v.resize(-3);
+    CHECK(v.getSize() == 0);
+    v.resize(3);
+    CHECK((contents(v) == std::vector<int>{0, 0, 0}));
+}
+
+// growing one element at a time through resize must reallocate
+// geometrically, like push_back, not on every call
+void resizeGrowsGeometrically() {
+    Vector v;
+    int reallocations = 0;
+    int capacity = v.getCapacity();
+    for (int i = 0; i < 100000; i++) {
+        v.resize(v.getSize() + 1, i);
+        if (v.getCapacity() != capacity) {
+            reallocations++;
+            capacity = v.getCapacity();
+        }
+    }
+    CHECK(reallocations <= 20);
+    CHECK(v.get(99999) == 99999);
+
+    Vector u;
+    for (int i = 0; i < 1000; i++) u.resize_uninitialized(u.getSize() + 3);
+    CHECK(u.getSize() == 3000 && u.getCapacity() < 2 * 3000 + 3);
+}
+
+std::vector<int> randomInts(long n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<int> v(n);
+    for (int& x : v) x = (int)rng();
+    return v;
+}
+
+void parallelMatchesSequential() {
+    ThreadPool pool(4);
+    for (long n : {parallel::kParallelThreshold - 1, parallel::kParallelThreshold, 3 * parallel::kParallelThreshold + 7, 1L << 20}) {
+        std::vector<int> data = randomInts(n, (unsigned)n);
+
+        std::vector<int> sorted = data;
+        parallel::sort(sorted.data(), sorted.data() + n, pool);
+        std::vector<int> want = data;
+        std::sort(want.begin(), want.end());
+        CHECK(sorted == want);
+
+        long long sum = parallel::reduce(data.data(), data.data() + n, 0LL,
+                                         [](long long a, long long b) { return a + b; }, pool);
+        CHECK(sum == std::accumulate(data.begin(), data.end(), 0LL));
+        int best = parallel::reduce(data.data(), data.data() + n, data[0],
+                                    [](int a, int b) { return std::max(a, b); }, pool);
+        CHECK(best == *std::max_element(data.begin(), data.end()));
+    }
+
+    Vector v;
+    std::vector<int> data = randomInts(1 << 18, 7);
+    v.append(data);
+    parallel::sort(v, pool);
+    std::sort(data.begin(), data.end());
+    CHECK(contents(v) == data);
+}
+
+} // namespace
+
+int main() {
+    appendFromSelf();
+    insertFromSelf();
+    resizeFill();
+    resizeGrowsGeometrically();
+    parallelMatchesSequential();
+    return check::checkResult();
+}